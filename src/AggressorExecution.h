@@ -0,0 +1,52 @@
+#pragma once
+
+#include <limits>
+
+#include "Fill.h"
+#include "Side.h"
+#include "Usings.h"
+
+// Execution report for one aggressing order: a summary (total filled, VWAP, levels touched)
+// plus a compact record per fill. Meant to be reused across orders, Reset keeps the fill
+// buffer's capacity so steady state matching does not allocate.
+class AggressorExecution
+{
+public:
+    void Reset(OrderId orderId, Side side)
+    {
+        orderId_ = orderId;
+        side_ = side;
+        filledQuantity_ = 0;
+        notional_ = 0;
+        levelsTouched_ = 0;
+        fills_.clear();
+    }
+
+    void AddFill(OrderId passiveOrderId, Price price, Quantity quantity)
+    {
+        if (fills_.empty() || fills_.back().price_ != price)
+            ++levelsTouched_;
+
+        filledQuantity_ += quantity;
+        notional_ += static_cast<std::int64_t>(price) * quantity;
+        fills_.push_back(Fill{ passiveOrderId, price, quantity });
+    }
+
+    OrderId GetOrderId() const { return orderId_; }
+    Side GetSide() const { return side_; }
+    Quantity GetFilledQuantity() const { return filledQuantity_; }
+    std::uint32_t GetLevelsTouched() const { return levelsTouched_; }
+    const Fills& GetFills() const { return fills_; }
+    double GetVwap() const 
+    { 
+        return filledQuantity_ ? static_cast<double>(notional_) / filledQuantity_ : std::numeric_limits<double>::quiet_NaN(); 
+    }
+
+private:
+    OrderId orderId_{ };
+    Side side_{ Side::Buy };
+    Quantity filledQuantity_{ };
+    std::int64_t notional_{ };
+    std::uint32_t levelsTouched_{ };
+    Fills fills_;
+};
@@ -0,0 +1,76 @@
+#include "Arena.h"
+
+#if defined(__linux__)
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+
+namespace
+{
+    constexpr std::size_t HugePageSize = 2 * 1024 * 1024;
+    constexpr std::size_t PageSize = 4 * 1024;
+    constexpr int BindPolicy = 2;  // MPOL_BIND, spelled out to avoid depending on libnuma headers
+}
+
+
+Arena::Arena(std::size_t capacity, Options options)
+{
+#if defined(__linux__)
+    // Round up to whole huge pages so the region can be mapped either way.
+    const std::size_t size = (capacity + HugePageSize - 1) / HugePageSize * HugePageSize;
+    void* memory = MAP_FAILED;
+
+    if (options.hugePages_) {
+        memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        hugePages_ = memory != MAP_FAILED;
+    }
+
+    if (memory == MAP_FAILED) {
+        // No reserved huge pages, ask for transparent huge pages on a regular mapping instead.
+        memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED)
+            throw std::bad_alloc();
+
+        if (options.hugePages_)
+            madvise(memory, size, MADV_HUGEPAGE);
+    }
+
+    base_ = static_cast<char*>(memory);
+    capacity_ = size;
+    mappedSize_ = size;
+
+    if (options.bindToLocalNode_) {
+        unsigned cpu = 0, node = 0;
+        if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0) {
+            // Binding fails on kernels without NUMA support, the memory is still usable.
+            unsigned long nodeMask[16]{ };
+            nodeMask[node / (8 * sizeof(unsigned long))] |= 1UL << (node % (8 * sizeof(unsigned long)));
+            if (syscall(SYS_mbind, base_, size, BindPolicy, nodeMask, sizeof(nodeMask) * 8, 0) == 0)
+                node_ = static_cast<int>(node);
+        }
+    }
+
+    // Touch every page after binding so they are faulted in on the right node up front.
+    if (options.prefault_) {
+        const std::size_t stride = hugePages_ ? HugePageSize : PageSize;
+        for (std::size_t offset = 0; offset < size; offset += stride)
+            base_[offset] = 0;
+    }
+#else
+    // Without the platform hooks every allocation is forwarded to the default heap.
+    (void)capacity;
+    (void)options;
+#endif
+}
+
+
+Arena::~Arena()
+{
+#if defined(__linux__)
+    if (base_)
+        munmap(base_, mappedSize_);
+#endif
+}
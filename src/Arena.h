@@ -0,0 +1,170 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+// Fixed-capacity memory region for the OrderBook's containers and orders.
+// The region is backed by 2MB huge pages where the system provides them (falling back to
+// transparent huge pages and then to regular pages), bound to the NUMA node of the thread
+// that constructs it and pre-faulted so the first orders do not pay for page faults.
+//
+// Allocation is a bump pointer with per size-class free lists, freed blocks are reused by
+// later allocations of the same class. Requests the region can no longer satisfy fall back
+// to the default heap. An Arena is not thread safe, it belongs to the thread owning the book.
+class Arena
+{
+public:
+    struct Options
+    {
+        bool hugePages_{ true };
+        bool prefault_{ true };
+        bool bindToLocalNode_{ true };
+    };
+
+    explicit Arena(std::size_t capacity) : Arena(capacity, Options{ }) { }
+    Arena(std::size_t capacity, Options options);
+    ~Arena();
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* Allocate(std::size_t size, std::size_t alignment)
+    {
+        // Over-aligned types are rare in the book, leave them to the heap.
+        if (alignment > Granularity)
+            return ::operator new(size, std::align_val_t{ alignment });
+
+        const std::size_t sizeClass = SizeClass(size);
+
+        if (auto* block = freeLists_[sizeClass]) {
+            freeLists_[sizeClass] = block->next_;
+            return block;
+        }
+
+        const std::size_t blockSize = BlockSize(sizeClass);
+        if (blockSize > capacity_ - offset_)
+            return ::operator new(size);
+
+        void* block = base_ + offset_;
+        offset_ += blockSize;
+        return block;
+    }
+
+    void Deallocate(void* pointer, std::size_t size, std::size_t alignment)
+    {
+        if (alignment > Granularity) {
+            ::operator delete(pointer, std::align_val_t{ alignment });
+            return;
+        }
+
+        if (!Owns(pointer)) {
+            ::operator delete(pointer);
+            return;
+        }
+
+        auto* block = static_cast<FreeBlock*>(pointer);
+        const std::size_t sizeClass = SizeClass(size);
+        block->next_ = freeLists_[sizeClass];
+        freeLists_[sizeClass] = block;
+    }
+
+    bool Owns(const void* pointer) const
+    {
+        const auto* bytes = static_cast<const char*>(pointer);
+        return bytes >= base_ && bytes < base_ + capacity_;
+    }
+
+    std::size_t GetCapacity() const { return capacity_; }
+    std::size_t GetUsed() const { return offset_; }
+    bool UsesHugePages() const { return hugePages_; }
+    int GetNode() const { return node_; }
+
+private:
+    struct FreeBlock
+    {
+        FreeBlock* next_;
+    };
+
+    // Sizes up to SmallLimit use Granularity-spaced classes, larger sizes power-of-two classes.
+    static constexpr std::size_t Granularity = 16;
+    static constexpr std::size_t SmallLimit = 1024;
+    static constexpr std::size_t SmallClasses = SmallLimit / Granularity;
+    static constexpr std::size_t ClassCount = SmallClasses + 48;
+
+    static std::size_t SizeClass(std::size_t size)
+    {
+        if (size <= SmallLimit)
+            return (size + Granularity - 1) / Granularity;
+
+        std::size_t sizeClass = SmallClasses + 1;
+        std::size_t blockSize = SmallLimit * 2;
+        while (blockSize < size) {
+            blockSize *= 2;
+            ++sizeClass;
+        }
+        return sizeClass;
+    }
+
+    static std::size_t BlockSize(std::size_t sizeClass)
+    {
+        if (sizeClass <= SmallClasses)
+            return (sizeClass ? sizeClass : 1) * Granularity;
+
+        return SmallLimit << (sizeClass - SmallClasses);
+    }
+
+    char* base_{ nullptr };
+    std::size_t capacity_{ };
+    std::size_t offset_{ };
+    std::size_t mappedSize_{ };
+    bool hugePages_{ false };
+    int node_{ -1 };
+    std::array<FreeBlock*, ClassCount> freeLists_{ };
+};
+
+
+// Standard allocator over an Arena. A null arena allocates from the default heap, which is
+// how an OrderBook runs with the arena layer switched off.
+template <typename T>
+class ArenaAllocator
+{
+public:
+    using value_type = T;
+
+    ArenaAllocator(Arena* arena = nullptr) noexcept
+        : arena_{ arena }
+    { }
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept
+        : arena_{ other.GetArena() }
+    { }
+
+    T* allocate(std::size_t count)
+    {
+        if (!arena_)
+            return static_cast<T*>(::operator new(count * sizeof(T)));
+
+        return static_cast<T*>(arena_->Allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* pointer, std::size_t count) noexcept
+    {
+        if (!arena_) {
+            ::operator delete(pointer);
+            return;
+        }
+
+        arena_->Deallocate(pointer, count * sizeof(T), alignof(T));
+    }
+
+    Arena* GetArena() const noexcept { return arena_; }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const noexcept { return arena_ == other.GetArena(); }
+
+private:
+    Arena* arena_;
+};
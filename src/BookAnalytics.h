@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+
+#include "Usings.h"
+
+// Book and trade analytics maintained incrementally by the OrderBook.
+// Prices are NaN while the inputs they need (both sides of the book, or trades) are missing.
+struct BookAnalytics
+{
+    Quantity bidDepth_;           // Volume in the top AnalyticsLevels bid levels
+    Quantity askDepth_;           // Volume in the top AnalyticsLevels ask levels
+    double imbalance_;            // (bidDepth - askDepth) / (bidDepth + askDepth), 0 for an empty book
+    double microprice_;           // Best prices weighted by the opposite side's best level volume
+    double sessionVwap_;
+    std::uint64_t sessionVolume_;
+    double rollingVwap_;          // Over trades in the last VwapWindow whole seconds of book time
+    std::uint64_t rollingVolume_;
+};
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "Usings.h"
+
+// One fill of an aggressing order, from the passive side. The aggressor's id, side and running
+// totals are carried once by the AggressorExecution holding the fill.
+struct Fill
+{
+    OrderId passiveOrderId_;
+    Price price_;
+    Quantity quantity_;
+};
+
+using Fills = std::vector<Fill>;
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "Order.h"
+#include "Usings.h"
+
+// Notified by the OrderBook, on the matching thread, of every order it accepts, of every fill,
+// with the incoming order and the resting order it traded against, and of quantity that leaves
+// without trading: cancelled, expired, reduced, replaced by a modify or killed. Resting pegged
+// orders left crossed by a move of the touch are matched with each other and reported through
+// OnCrossedFill, as neither is an incoming order.
+class FillListener
+{
+public:
+    virtual ~FillListener() = default;
+    virtual void OnAccept(const Order& order) = 0;
+    virtual void OnFill(const Order& aggressor, const Order& resting, Price price, Quantity quantity) = 0;
+    virtual void OnCrossedFill(const Order& buy, const Order& sell, Price price, Quantity quantity) = 0;
+    virtual void OnCancel(const Order& order, Quantity quantity) = 0;
+};
@@ -5,35 +5,61 @@
 #include <format>
 
 #include "OrderType.h"
+#include "PegType.h"
 #include "Side.h"
 #include "Usings.h"
 #include "Constants.h"
+#include "Arena.h"
 
 
 class Order
 {
 public:
-    Order(OrderType orderType, OrderId orderId, Side side, Price price, Quantity quantity)
+    // Intrusive links threading together every resting order owned by the same participant.
+    // Maintained by the OrderBook so it can mass cancel without scanning all orders.
+    struct ParticipantLink
+    {
+        Order* prev_{ nullptr };
+        Order* next_{ nullptr };
+    };
+
+    Order(OrderType orderType, OrderId orderId, Side side, Price price, Quantity quantity, ParticipantId participantId = { })
         : orderType_{ orderType }
         , orderId_{ orderId }
+        , participantId_{ participantId }
         , side_{ side }
         , price_{ price }
         , initialQuantity_{ quantity }
         , remainingQuantity_{ quantity }
     { }
 
-    Order(OrderId orderId, Side side, Quantity quantity)
-        : Order(OrderType::Market, orderId, side, Constants::InvalidPrice, quantity)
+    Order(OrderId orderId, Side side, Quantity quantity, ParticipantId participantId = { })
+        : Order(OrderType::Market, orderId, side, Constants::InvalidPrice, quantity, participantId)
     { }
 
+    // Pegged orders have no price of their own, it is derived from the book by the OrderBook.
+    Order(PegType pegType, OrderId orderId, Side side, Price pegOffset, Quantity quantity, ParticipantId participantId = { })
+        : Order(OrderType::GoodTillCancel, orderId, side, Constants::InvalidPrice, quantity, participantId)
+    {
+        pegType_ = pegType;
+        pegOffset_ = pegOffset;
+    }
+
     OrderId GetOrderId() const { return orderId_; }
+    ParticipantId GetParticipantId() const { return participantId_; }
     Side GetSide() const { return side_; }
     Price GetPrice() const { return price_; }
     OrderType GetOrderType() const { return orderType_; }
+    PegType GetPegType() const { return pegType_; }
+    Price GetPegOffset() const { return pegOffset_; }
+    bool IsPegged() const { return GetPegType() != PegType::None; }
+    std::uint64_t GetSequence() const { return sequence_; }
+    void SetSequence(std::uint64_t sequence) { sequence_ = sequence; }
     Quantity GetInitialQuantity() const { return initialQuantity_; }
     Quantity GetRemainingQuantity() const { return remainingQuantity_; }
     Quantity GetFilledQuantity() const { return GetInitialQuantity() - GetRemainingQuantity(); }
     bool IsFilled() const { return GetRemainingQuantity() == 0; }
+    ParticipantLink& GetParticipantLink() { return participantLink_; }
     void Fill(Quantity quantity)
     {
         if (quantity > GetRemainingQuantity())
@@ -41,24 +67,30 @@ public:
 
         remainingQuantity_ -= quantity;
     }
-    void ToGoodTillCancel(Price price) 
-    { 
-        if (GetOrderType() != OrderType::Market)
-            throw std::logic_error(std::format("Order ({}) cannot have its price adjusted, only market orders can.", GetOrderId()));
+    // Lowers the open quantity without counting it as filled.
+    void Reduce(Quantity quantity)
+    {
+        if (quantity > GetRemainingQuantity())
+            throw std::logic_error(std::format("Order ({}) cannot be reduced by more than its remaining quantity.", GetOrderId()));
 
-        price_ = price;
-        orderType_ = OrderType::GoodTillCancel;
+        initialQuantity_ -= quantity;
+        remainingQuantity_ -= quantity;
     }
 
 private:
     OrderType orderType_;
     OrderId orderId_;
+    ParticipantId participantId_;
     Side side_;
     Price price_;
     Quantity initialQuantity_;
     Quantity remainingQuantity_;
+    PegType pegType_{ PegType::None };
+    Price pegOffset_{ };
+    std::uint64_t sequence_{ };     // Arrival order in the book, breaks price ties between limit and pegged orders
+    ParticipantLink participantLink_;
 };
 
 using OrderPointer = std::shared_ptr<Order>;
-using OrderPointers = std::list<OrderPointer>;
+using OrderPointers = std::list<OrderPointer, ArenaAllocator<OrderPointer>>;
 
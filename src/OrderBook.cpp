@@ -1,9 +1,38 @@
+#include <algorithm>
 #include <iostream>
 #include <numeric>
 #include <chrono>
 #include "OrderBook.h"
 
 
+OrderBook::OrderBook(Arena* arena)
+    : arena_{ arena }
+    , bids_{ ArenaAllocator<OrderPointer>{ arena } }
+    , asks_{ ArenaAllocator<OrderPointer>{ arena } }
+    , orders_{ 0, ArenaAllocator<OrderPointer>{ arena } }
+    , bidPegs_{ Levels<std::greater<Price>>{ ArenaAllocator<OrderPointer>{ arena } },
+        Levels<std::greater<Price>>{ ArenaAllocator<OrderPointer>{ arena } } }
+    , askPegs_{ Levels<std::less<Price>>{ ArenaAllocator<OrderPointer>{ arena } },
+        Levels<std::less<Price>>{ ArenaAllocator<OrderPointer>{ arena } } }
+    , priceLevelMetaData_{ HashMap<Price, LevelData>{ 0, ArenaAllocator<OrderPointer>{ arena } },
+        HashMap<Price, LevelData>{ 0, ArenaAllocator<OrderPointer>{ arena } } }
+    , participantOrders_{ 0, ArenaAllocator<OrderPointer>{ arena } }
+{ }
+
+
+OrderPointer OrderBook::MakeOrder(OrderType orderType, OrderId orderId, Side side, Price price, Quantity quantity, ParticipantId participantId) const
+{
+    // The order and its control block live in the book's arena alongside the containers.
+    return std::allocate_shared<Order>(ArenaAllocator<Order>{ arena_ }, orderType, orderId, side, price, quantity, participantId);
+}
+
+
+OrderPointer OrderBook::MakeOrder(PegType pegType, OrderId orderId, Side side, Price pegOffset, Quantity quantity, ParticipantId participantId) const
+{
+    return std::allocate_shared<Order>(ArenaAllocator<Order>{ arena_ }, pegType, orderId, side, pegOffset, quantity, participantId);
+}
+
+
 void OrderBook::pruneGoodForDayOrders()
 {
     const auto end = std::chrono::hours(16);  // prune GoodForDay orders at 4pm
@@ -39,33 +68,124 @@ void OrderBook::CancelOrders(OrderIds orderIds)
     {
         CancelOrderInternal(orderId);
     }
+    MatchCrossedPegs();
 }
 
 
 void OrderBook::CancelOrderInternal(OrderId orderId)
 {
+    const auto order = EraseOrder(orderId);
+    if (order && !order->IsPegged())
+        OnOrderCancelled(order);
+
+    if (order && fillListener_)
+        fillListener_->OnCancel(*order, order->GetRemainingQuantity());
+}
+
+
+void OrderBook::InsertOrder(OrderPointer order)
+{
+    order->SetSequence(nextSequence_++);
+
+    auto Append = [&order](auto& levels, Price key)
+    {
+        auto& orders = levels[key];
+        orders.push_back(order);
+        return std::prev(orders.end());
+    };
+
+    OrderPointers::iterator iterator;
+    const auto pegIndex = static_cast<std::size_t>(order->GetPegType()) - 1;
+
+    if (order->IsPegged())
+        iterator = order->GetSide() == Side::Buy
+            ? Append(bidPegs_[pegIndex], order->GetPegOffset())
+            : Append(askPegs_[pegIndex], order->GetPegOffset());
+    else
+        iterator = order->GetSide() == Side::Buy
+            ? Append(bids_, order->GetPrice())
+            : Append(asks_, order->GetPrice());
+
+    orders_.insert({ order->GetOrderId(), OrderEntry{ order, iterator }});
+    LinkParticipantOrder(order.get());
+
+    // Pegged orders have no fixed level, so they stay out of the level meta data.
+    if (!order->IsPegged())
+        OnOrderAdded(order);
+}
+
+
+OrderPointer OrderBook::EraseOrder(OrderId orderId)
+{
+    // Removes a resting order from its level, orders_ and its participant list. Level meta
+    // data is left to the caller as cancels and fills account for it differently.
     if (!orders_.contains(orderId)) 
-        return;
+        return nullptr;
     
-    const auto& [order, iterator] = orders_.at(orderId);
+    // Copy the entry out, erasing it from orders_ would otherwise leave us with dangling references.
+    const auto [order, iterator] = orders_.at(orderId);
     orders_.erase(orderId);
 
-    if (order->GetSide() == Side::Sell)
+    auto EraseFrom = [&iterator](auto& levels, Price key)
     {
-        auto price = order->GetPrice();
-        auto& orders = asks_.at(price);
+        auto& orders = levels.at(key);
         orders.erase(iterator);
         if (orders.empty())
-            asks_.erase(price);
+            levels.erase(key);
+    };
+
+    const auto pegIndex = static_cast<std::size_t>(order->GetPegType()) - 1;
+
+    if (order->IsPegged())
+    {
+        if (order->GetSide() == Side::Buy)
+            EraseFrom(bidPegs_[pegIndex], order->GetPegOffset());
+        else
+            EraseFrom(askPegs_[pegIndex], order->GetPegOffset());
     }
     else
     {
-        auto price = order->GetPrice();
-        auto& orders = bids_.at(price);
-        orders.erase(iterator);
-        if (orders.empty())
-            bids_.erase(price);
+        if (order->GetSide() == Side::Buy)
+            EraseFrom(bids_, order->GetPrice());
+        else
+            EraseFrom(asks_, order->GetPrice());
     }
+
+    UnlinkParticipantOrder(order.get());
+    return order;
+}
+
+
+void OrderBook::LinkParticipantOrder(Order* order)
+{
+    // Push the order onto the front of its participant's intrusive list.
+    auto& head = participantOrders_[order->GetParticipantId()];
+    auto& link = order->GetParticipantLink();
+
+    link.prev_ = nullptr;
+    link.next_ = head;
+    if (head)
+        head->GetParticipantLink().prev_ = order;
+    head = order;
+}
+
+
+void OrderBook::UnlinkParticipantOrder(Order* order)
+{
+    auto& link = order->GetParticipantLink();
+
+    if (link.prev_)
+        link.prev_->GetParticipantLink().next_ = link.next_;
+    else if (link.next_)
+        participantOrders_.at(order->GetParticipantId()) = link.next_;
+    else
+        participantOrders_.erase(order->GetParticipantId());
+
+    if (link.next_)
+        link.next_->GetParticipantLink().prev_ = link.prev_;
+
+    link.prev_ = nullptr;
+    link.next_ = nullptr;
 }
 
 
@@ -97,71 +217,176 @@ bool OrderBook::CanMatch(Side side, Price price) const
 }
 
 
-Trades OrderBook::MatchOrders()
+std::optional<Price> OrderBook::GetPegReferencePrice(Side side, PegType pegType) const
 {
-    Trades trades;
-    trades.reserve(orders_.size());
+    // References are taken from limit orders only, pegs never peg to each other.
+    if (pegType == PegType::Primary) {
+        if (side == Side::Buy)
+            return bids_.empty() ? std::nullopt : std::optional<Price>{ bids_.begin()->first };
+        return asks_.empty() ? std::nullopt : std::optional<Price>{ asks_.begin()->first };
+    }
 
-    while (true) {
-        
-        if (bids_.empty() || asks_.empty()) {
-            break;
+    if (bids_.empty() || asks_.empty())
+        return std::nullopt;
+
+    // A half tick midpoint rounds away from the opposite side: down for bids, up for asks.
+    const auto sum = static_cast<std::int64_t>(bids_.begin()->first) + asks_.begin()->first;
+    const auto midpoint = (sum - (sum & 1)) / 2;
+    return static_cast<Price>(side == Side::Buy ? midpoint : midpoint + (sum & 1));
+}
+
+
+std::optional<Price> OrderBook::GetEffectivePrice(const Order& order) const
+{
+    // A pegged order without a reference price is inactive and has no price.
+    if (!order.IsPegged())
+        return order.GetPrice();
+
+    const auto reference = GetPegReferencePrice(order.GetSide(), order.GetPegType());
+    if (!reference)
+        return std::nullopt;
+
+    return *reference + order.GetPegOffset();
+}
+
+
+std::optional<OrderBook::MatchCandidate> OrderBook::GetBestResting(Side side) const
+{
+    // Compares the front of the best limit level with the front of the best level of each peg
+    // type, by price and then arrival. Pegs without a reference price are inactive.
+    std::optional<MatchCandidate> best;
+
+    auto Consider = [side, &best](const auto& levels, Price reference)
+    {
+        if (levels.empty())
+            return;
+
+        const auto& [key, orders] = *levels.begin();
+        const MatchCandidate candidate{ orders.front().get(), reference + key };
+
+        const bool isBetter = !best
+            || (side == Side::Buy ? candidate.price_ > best->price_ : candidate.price_ < best->price_)
+            || (candidate.price_ == best->price_ && candidate.order_->GetSequence() < best->order_->GetSequence());
+
+        if (isBetter)
+            best = candidate;
+    };
+
+    auto ConsiderSide = [this, side, &Consider](const auto& levels, const auto& pegs)
+    {
+        Consider(levels, 0);
+
+        for (auto pegType : { PegType::Primary, PegType::Midpoint }) {
+            const auto reference = GetPegReferencePrice(side, pegType);
+            if (reference)
+                Consider(pegs[static_cast<std::size_t>(pegType) - 1], *reference);
         }
+    };
+
+    if (side == Side::Buy)
+        ConsiderSide(bids_, bidPegs_);
+    else
+        ConsiderSide(asks_, askPegs_);
+
+    return best;
+}
 
-        auto& [bidPrice, bids] = *bids_.begin();
-        auto& [askPrice, asks] = *asks_.begin();
 
-        if (bidPrice < askPrice) {
+void OrderBook::MatchOrders(OrderPointer order, AggressorExecution& execution)
+{
+    // Match an incoming order against the opposite side before it is added to the book, so
+    // pegged orders are priced off the book as the aggressor found it. Every fill re-reads the
+    // best resting order, letting pegs follow the touch as the aggressor walks through levels.
+    // Fills are written to the caller's execution, nothing here allocates once it has capacity.
+    // An incoming pegged order trades at its effective price, which can only cross pegs on the
+    // other side as it never crosses the limit orders it is priced from.
+    const Side restingSide = order->GetSide() == Side::Buy ? Side::Sell : Side::Buy;
+    const bool isMarket = order->GetOrderType() == OrderType::Market;
+
+    while (!order->IsFilled()) {
+        const auto best = GetBestResting(restingSide);
+        if (!best)
+            break;
+
+        const auto [resting, price] = *best;
+        const auto limit = GetEffectivePrice(*order);
+        const bool crosses = limit && (order->GetSide() == Side::Buy ? *limit >= price : *limit <= price);
+        if (!isMarket && !crosses)
             break;
-        }
 
-        while (bids.size() && asks.size()) {
-            auto& bid = bids.front();
-            auto& ask = asks.front();
+        Quantity quantity = std::min(order->GetRemainingQuantity(), resting->GetRemainingQuantity());
 
-            Quantity quantity = std::min(bid->GetRemainingQuantity(), ask->GetRemainingQuantity());
+        order->Fill(quantity);
+        FillResting(*resting, price, quantity);
+        OnTradeExecuted(price, quantity);
+        execution.AddFill(resting->GetOrderId(), price, quantity);
 
-            bid->Fill(quantity);
-            ask->Fill(quantity);
+        if (fillListener_)
+            fillListener_->OnFill(*order, *resting, price, quantity);
 
-            if (bid->IsFilled()) {
-                bids.pop_front();
-                orders_.erase(bid->GetOrderId());
-            }
+        if (resting->IsFilled())
+            EraseOrder(resting->GetOrderId());
+    }
+}
 
-            if (ask->IsFilled()) {
-                asks.pop_front();
-                orders_.erase(ask->GetOrderId());
-            }
 
-            if (bids.empty()) {
-                bids_.erase(bidPrice);
-            }
+void OrderBook::MatchCrossedPegs()
+{
+    // Limit orders never rest crossed, but pegged orders reprice whenever the touch moves and
+    // can end up locked or crossed with pegs on the other side. Only the fronts of each side
+    // are compared, so this is cheap after every change to the book. The later of the two
+    // orders is treated as the aggressor and trades at the earlier one's price.
+    const auto hasPegs = [](const auto& pegs) { return !pegs[0].empty() || !pegs[1].empty(); };
+    if (!hasPegs(bidPegs_) && !hasPegs(askPegs_))
+        return;
 
-            if (asks.empty()) {
-                asks_.erase(askPrice);
-            }
+    while (true) {
+        const auto bid = GetBestResting(Side::Buy);
+        const auto ask = GetBestResting(Side::Sell);
+        if (!bid || !ask || bid->price_ < ask->price_)
+            return;
+
+        const Price price = bid->order_->GetSequence() < ask->order_->GetSequence() ? bid->price_ : ask->price_;
+        const Quantity quantity = std::min(bid->order_->GetRemainingQuantity(), ask->order_->GetRemainingQuantity());
+
+        FillResting(*bid->order_, price, quantity);
+        FillResting(*ask->order_, price, quantity);
+        OnTradeExecuted(price, quantity);
+
+        if (fillListener_)
+            fillListener_->OnCrossedFill(*bid->order_, *ask->order_, price, quantity);
 
-            trades.push_back(Trade{
-                TradeInfo{ bid->GetOrderId(), bid->GetPrice(), quantity }, 
-                TradeInfo{ ask->GetOrderId(), ask->GetPrice(), quantity }
-                });
+        for (const auto* order : { bid->order_, ask->order_ }) {
+            if (order->IsFilled())
+                EraseOrder(order->GetOrderId());
         }
     }
-    // For Fill and Kill orders - if it's not fully filled we need to remove it from the Order Book. 
-    if (!bids_.empty()) {
-        auto& [_, bids] = *bids_.begin();
-        auto& order = bids.front();
-        if (order->GetOrderType() == OrderType::FillAndKill) {
-            CancelOrder(order->GetOrderId()); 
-        }
+}
+
+
+void OrderBook::FillResting(Order& order, Price price, Quantity quantity)
+{
+    order.Fill(quantity);
+    if (!order.IsPegged()) {
+        OnOrderMatched(order.GetSide(), order.GetPrice(), quantity);
+        PublishMarketByOrder(MarketByOrderEventType::Executed, order, price, quantity);
     }
-    if (!asks_.empty()) {
-        auto& [_, asks] = *asks_.begin();
-        auto& order = asks.front();
-        if (order->GetOrderType() == OrderType::FillAndKill) {
-            CancelOrder(order->GetOrderId()); 
-        }
+}
+
+
+Trades OrderBook::ToTrades(const AggressorExecution& execution) const
+{
+    Trades trades;
+    trades.reserve(execution.GetFills().size());
+
+    for (const auto& fill : execution.GetFills()) {
+        TradeInfo aggressorTrade{ execution.GetOrderId(), fill.price_, fill.quantity_ };
+        TradeInfo restingTrade{ fill.passiveOrderId_, fill.price_, fill.quantity_ };
+
+        if (execution.GetSide() == Side::Buy)
+            trades.push_back(Trade{ aggressorTrade, restingTrade });
+        else
+            trades.push_back(Trade{ restingTrade, aggressorTrade });
     }
     return trades;
 }
@@ -169,103 +394,155 @@ Trades OrderBook::MatchOrders()
 
 Trades OrderBook::AddOrder(OrderPointer order)
 {
+    AddOrder(order, execution_);
+    return ToTrades(execution_);
+}
+
+
+void OrderBook::AddOrder(OrderPointer order, AggressorExecution& execution)
+{
+    execution.Reset(order->GetOrderId(), order->GetSide());
+
     if (orders_.contains(order->GetOrderId())) {
         std::cout<< "Rejecting Order : " << order->GetOrderId() << ". Already present in Order Book." << std::endl;
-        return { };
-    }
-
-    if (order->GetOrderType() == OrderType::FillAndKill && !CanMatch(order->GetSide(), order->GetPrice())) {
-        return { };
+        return;
     }
 
-    if (order->GetOrderType() == OrderType::Market)
-    {
-        // To handle market orders we first check that there is volume on opposite side of the book
-        // Provided there is volume, transform the order to a Good Till Cancel on the worst price they 
-        // can be filled at.
-        if (order->GetSide() == Side::Sell && !asks_.empty()) 
-        {
-            const auto& [worstAsk, _] = *asks_.rbegin();
-            order->ToGoodTillCancel(worstAsk);
+    if (order->IsPegged()) {
+        // Pegged orders only ever provide liquidity, so their offset may not be more aggressive
+        // than the reference price.
+        const bool isAggressive = order->GetSide() == Side::Buy ? order->GetPegOffset() > 0 : order->GetPegOffset() < 0;
+        if (isAggressive) {
+            std::cout<< "Rejecting Order : " << order->GetOrderId() << ". Peg offset crosses its reference price." << std::endl;
+            return;
         }
+    }
 
-        else if (order->GetSide() == Side::Buy && !bids_.empty())
-        {
-            const auto& [worstBid, _]  = *bids_.rbegin();
-            order->ToGoodTillCancel(worstBid);
-        }
+    if (order->GetOrderType() == OrderType::FillOrKill
+        && !CanFullyFill(order->GetPrice(), order->GetInitialQuantity(), order->GetSide()))
+        return;
 
-        // no volume on other side, so return empty set of trades.
-        else 
-        {
-            return { };
-        }
-    }
+    if (fillListener_)
+        fillListener_->OnAccept(*order);
 
-    OrderPointers::iterator iterator;
+    MatchOrders(order, execution);
 
-    if (order->GetSide() == Side::Buy) {
-        auto& orders = bids_[order->GetPrice()];
-        orders.push_back(order);
-        iterator = std::next(orders.begin(), orders.size()-1);
-    }
-    else {
-        auto& orders = asks_[order->GetPrice()];
-        orders.push_back(order);
-        iterator = std::next(orders.begin(), orders.size()-1);
+    // Market, Fill and Kill and Fill or Kill orders never rest, any unfilled remainder is cancelled.
+    const bool canRest = order->GetOrderType() != OrderType::Market
+        && order->GetOrderType() != OrderType::FillAndKill
+        && order->GetOrderType() != OrderType::FillOrKill;
+    if (!order->IsFilled()) {
+        if (canRest)
+            InsertOrder(order);
+        else if (fillListener_)
+            fillListener_->OnCancel(*order, order->GetRemainingQuantity());
     }
 
-    orders_.insert({ order->GetOrderId(), OrderEntry{ order, iterator }});
-    OnOrderAdded(order);
-    return MatchOrders();
+    MatchCrossedPegs();
 }
 
 
 void OrderBook::CancelOrder(OrderId orderId)
 {
-    if (!orders_.contains(orderId)) {
-        return;
+    CancelOrderInternal(orderId);
+    MatchCrossedPegs();
+}
+
+
+std::size_t OrderBook::MassCancel(ParticipantId participantId, std::optional<Side> side, Price minPrice, Price maxPrice)
+{
+    // Walks only this participant's intrusive order list, so the cost is proportional to the
+    // number of orders they have resting rather than the size of the book.
+    if (!participantOrders_.contains(participantId))
+        return 0;
+
+    // Pegged orders are matched on their effective price, taken from the book as it was before
+    // any of the cancels moved it. Inactive pegs have no price and are always cancelled.
+    std::array<std::array<std::optional<Price>, 2>, 2> pegReferences;
+    for (auto pegSide : { Side::Buy, Side::Sell }) {
+        for (auto pegType : { PegType::Primary, PegType::Midpoint })
+            pegReferences[static_cast<std::size_t>(pegSide)][static_cast<std::size_t>(pegType) - 1] = GetPegReferencePrice(pegSide, pegType);
     }
 
-    const auto& [order, orderIterator] = orders_.at(orderId);
-    orders_.erase(orderId);
+    std::size_t cancelled = 0;
+    Order* order = participantOrders_.at(participantId);
 
-    if (order->GetSide() == Side::Sell) {
-        Price price = order->GetPrice();
-        auto& orders = asks_.at(price);
-        orders.erase(orderIterator); 
+    while (order) {
+        // Grab the next link first, cancelling releases the current order.
+        Order* next = order->GetParticipantLink().next_;
 
-        if (orders.empty()) {
-            asks_.erase(price); 
+        std::optional<Price> price = order->GetPrice();
+        if (order->IsPegged()) {
+            const auto& reference = pegReferences[static_cast<std::size_t>(order->GetSide())][static_cast<std::size_t>(order->GetPegType()) - 1];
+            price = reference ? std::optional<Price>{ *reference + order->GetPegOffset() } : std::nullopt;
         }
-    }
 
-    else {
-        Price price = order->GetPrice();
-        auto& orders = bids_.at(price);
-        orders.erase(orderIterator); 
-        if (orders.empty()) {
-            asks_.erase(price); 
+        const bool sideMatches = !side.has_value() || order->GetSide() == *side;
+        const bool priceMatches = !price || (*price >= minPrice && *price <= maxPrice);
+
+        if (sideMatches && priceMatches) {
+            CancelOrderInternal(order->GetOrderId());
+            ++cancelled;
         }
+
+        order = next;
     }
 
-    OnOrderCancelled(order);
+    MatchCrossedPegs();
+    return cancelled;
 }
 
 
 Trades OrderBook::ModifyOrder(OrderModify order)
+{
+    ModifyOrder(order, execution_);
+    return ToTrades(execution_);
+}
+
+
+void OrderBook::ModifyOrder(OrderModify order, AggressorExecution& execution)
 {
     if (!orders_.contains(order.GetOrderId())) {
-        return { };
+        execution.Reset(order.GetOrderId(), order.GetSide());
+        return;
     }
     
-    const auto& [existing_order, _] = orders_.at(order.GetOrderId());
+    const auto existing_order = orders_.at(order.GetOrderId()).order_;
+
+    // Only lowering the quantity of a limit order keeps its place in the queue.
+    const bool isReduction = !existing_order->IsPegged()
+        && order.GetSide() == existing_order->GetSide()
+        && order.GetPrice() == existing_order->GetPrice()
+        && order.GetQuantity() > 0
+        && order.GetQuantity() < existing_order->GetRemainingQuantity();
+
+    if (isReduction) {
+        execution.Reset(order.GetOrderId(), order.GetSide());
+        const Quantity reduction = existing_order->GetRemainingQuantity() - order.GetQuantity();
+        existing_order->Reduce(reduction);
+        UpdateLevelData(existing_order->GetSide(), existing_order->GetPrice(), reduction, LevelData::Action::Remove);
+        PublishMarketByOrder(MarketByOrderEventType::Reduced, *existing_order, existing_order->GetPrice(), reduction);
+        if (fillListener_)
+            fillListener_->OnCancel(*existing_order, reduction);
+        return;
+    }
+
     CancelOrder(existing_order->GetOrderId());
-    return AddOrder(order.ToOrderPointer(existing_order->GetOrderType()));
+
+    // A pegged order keeps its peg, the modify price is taken as its new offset.
+    if (existing_order->IsPegged()) {
+        AddOrder(MakeOrder(existing_order->GetPegType(), order.GetOrderId(), order.GetSide(), order.GetPrice(),
+            order.GetQuantity(), existing_order->GetParticipantId()), execution);
+        return;
+    }
+
+    AddOrder(MakeOrder(existing_order->GetOrderType(), order.GetOrderId(), order.GetSide(), order.GetPrice(),
+        order.GetQuantity(), existing_order->GetParticipantId()), execution);
 }
 
 OrderBookLevelInfos OrderBook::GetOrderInfos() const
 {
+    // Limit levels only, pegged orders have no fixed price to report them at.
     LevelInfos bidInfos, askInfos;
     bidInfos.reserve(orders_.size());
     askInfos.reserve(orders_.size());
@@ -288,28 +565,313 @@ OrderBookLevelInfos OrderBook::GetOrderInfos() const
 }
 
 
+std::optional<Price> OrderBook::GetBestPrice(Side side) const
+{
+    // Best limit price, same as the primary peg reference.
+    return GetPegReferencePrice(side, PegType::Primary);
+}
+
+
+Quantity OrderBook::GetLevelQuantity(Side side, Price price) const
+{
+    const auto& levels = priceLevelMetaData_[static_cast<std::size_t>(side)];
+    const auto iterator = levels.find(price);
+    return iterator == levels.end() ? 0 : iterator->second.quantity_;
+}
+
+
 std::size_t OrderBook::Size() const
 { 
     return orders_.size(); 
 }
 
 
+std::optional<ParticipantId> OrderBook::GetParticipantId(OrderId orderId) const
+{
+    const auto iterator = orders_.find(orderId);
+    if (iterator == orders_.end())
+        return std::nullopt;
+
+    return iterator->second.order_->GetParticipantId();
+}
+
+
+bool OrderBook::CopyOrders(MarketByOrderSnapshot& snapshot, std::size_t maxOrders) const
+{
+    // Visits at most maxOrders orders per call, copying them or skipping ones already copied,
+    // so a snapshot of any size only holds up matching for one level lookup and one chunk.
+    // Between calls the book may change: the cursor resumes right after the last order visited
+    // while it still rests, otherwise from the front of its level, skipping by arrival sequence,
+    // which stays valid whatever was added or removed. Every entry is stamped with the book
+    // sequence it was copied at so replayed events it already reflects can be skipped.
+    if (snapshot.complete_.load(std::memory_order_relaxed))
+        return true;
+
+    if (!snapshot.started_) {
+        snapshot.started_ = true;
+        snapshot.startSequence_ = bookSequence_;
+        snapshot.side_ = Side::Buy;
+        snapshot.price_.reset();
+        snapshot.orders_.clear();
+    }
+
+    std::size_t visited = 0;
+
+    auto ResumeAt = [this, &snapshot](const OrderPointers& orders) -> OrderPointers::const_iterator
+    {
+        // A matching sequence means the same order, not one re-added under its id by a modify.
+        const auto last = orders_.find(snapshot.orderId_);
+        if (last != orders_.end() && last->second.order_->GetSequence() == snapshot.orderIdSequence_)
+            return std::next(last->second.location_);
+        return orders.begin();
+    };
+
+    auto CopySide = [this, &snapshot, &visited, maxOrders, &ResumeAt](const auto& levels)
+    {
+        auto level = snapshot.price_ ? levels.lower_bound(*snapshot.price_) : levels.begin();
+
+        for (; level != levels.end(); ++level) {
+            const auto& orders = level->second;
+            const bool resuming = snapshot.price_ == level->first;
+            auto order = resuming ? ResumeAt(orders) : orders.begin();
+
+            for (; order != orders.end(); ++order) {
+                if (visited == maxOrders)
+                    return false;
+
+                ++visited;
+                snapshot.orderId_ = (*order)->GetOrderId();
+                snapshot.orderIdSequence_ = (*order)->GetSequence();
+
+                // Skips count against the chunk too, so walking a deep level is spread over calls.
+                if (resuming && (*order)->GetSequence() <= snapshot.orderSequence_)
+                    continue;
+
+                snapshot.orders_.push_back(MarketByOrderSnapshotEntry{ (*order)->GetOrderId(), (*order)->GetSide(),
+                    (*order)->GetPrice(), (*order)->GetRemainingQuantity(), bookSequence_ });
+                snapshot.price_ = level->first;
+                snapshot.orderSequence_ = (*order)->GetSequence();
+            }
+        }
+        return true;
+    };
+
+    if (snapshot.side_ == Side::Buy) {
+        if (!CopySide(bids_))
+            return false;
+
+        snapshot.side_ = Side::Sell;
+        snapshot.price_.reset();
+    }
+
+    if (!CopySide(asks_))
+        return false;
+
+    snapshot.endSequence_ = bookSequence_;
+    snapshot.complete_.store(true, std::memory_order_release);
+    return true;
+}
+
+
 void OrderBook::OnOrderCancelled(OrderPointer order)
 {
-    LevelData levelData = priceLevelMetaData_.at(order->GetPrice());
-    levelData.quantity_ -= order->GetRemainingQuantity();
-    
-    if (levelData.quantity_ < 0)
-        throw std::logic_error(std::format("Level Meta Data at price {} has negative volume", levelData.price_));
+    UpdateLevelData(order->GetSide(), order->GetPrice(), order->GetRemainingQuantity(), LevelData::Action::Remove);
+    PublishMarketByOrder(MarketByOrderEventType::Deleted, *order, order->GetPrice(), order->GetRemainingQuantity());
+}
 
-    if (levelData.quantity_ == 0)
-        priceLevelMetaData_.erase(levelData.price_);
+
+void OrderBook::OnOrderAdded(OrderPointer order)
+{
+    UpdateLevelData(order->GetSide(), order->GetPrice(), order->GetRemainingQuantity(), LevelData::Action::Add);
+    PublishMarketByOrder(MarketByOrderEventType::Added, *order, order->GetPrice(), order->GetRemainingQuantity());
+}
+
+
+void OrderBook::OnOrderMatched(Side side, Price price, Quantity quantity)
+{
+    UpdateLevelData(side, price, quantity, LevelData::Action::Match);
+}
+
+
+void OrderBook::PublishMarketByOrder(MarketByOrderEventType type, const Order& order, Price price, Quantity quantity)
+{
+    // Only called for limit orders, pegged orders are not displayed on the feed.
+    if (!marketByOrderRing_)
+        return;
+
+    marketByOrderRing_->Publish(MarketByOrderEvent{ ++bookSequence_, order.GetOrderId(), price, quantity, order.GetSide(), type });
+}
+
+
+void OrderBook::OnTradeExecuted(Price price, Quantity quantity)
+{
+    const auto notional = static_cast<std::int64_t>(price) * quantity;
+
+    sessionNotional_ += notional;
+    sessionVolume_ += quantity;
+
+    const auto second = AdvanceWindow();
+    auto& bucket = tradeWindow_[static_cast<std::size_t>(second) % tradeWindow_.size()];
+    bucket.second_ = second;
+    bucket.notional_ += notional;
+    bucket.volume_ += quantity;
+    windowNotional_ += notional;
+    windowVolume_ += quantity;
+}
+
+
+std::int64_t OrderBook::AdvanceWindow() const
+{
+    // Buckets are only cleared when the book time reaches a new second, so a trade costs one
+    // bucket update. Time going backwards is held at the latest second seen.
+    const auto second = std::chrono::duration_cast<std::chrono::seconds>(time_).count();
+    if (second <= windowSecond_)
+        return windowSecond_;
+
+    const auto oldest = second - static_cast<std::int64_t>(tradeWindow_.size());
+    for (auto& bucket : tradeWindow_) {
+        if (bucket.volume_ && bucket.second_ <= oldest) {
+            windowNotional_ -= bucket.notional_;
+            windowVolume_ -= bucket.volume_;
+            bucket = WindowBucket{ };
+        }
+    }
+
+    windowSecond_ = second;
+    return second;
+}
+
+
+void OrderBook::UpdateLevelData(Side side, Price price, Quantity quantity, LevelData::Action action)
+{
+    auto& levels = priceLevelMetaData_[static_cast<std::size_t>(side)];
+    auto [iterator, levelAdded] = levels.try_emplace(price, LevelData{ price, 0 });
+    auto& levelData = iterator->second;
+
+    if (action == LevelData::Action::Add) {
+        levelData.quantity_ += quantity;
+        UpdateDepth(side, price, quantity, true, levelAdded);
+        return;
+    }
+
+    if (quantity > levelData.quantity_)
+        throw std::logic_error(std::format("Level Meta Data at price {} has negative volume", price));
+
+    levelData.quantity_ -= quantity;
+
+    const bool levelRemoved = levelData.quantity_ == 0;
+    if (levelRemoved)
+        levels.erase(iterator);
+
+    UpdateDepth(side, price, quantity, false, levelRemoved);
+}
+
+
+void OrderBook::UpdateDepth(Side side, Price price, Quantity quantity, bool isAdd, bool levelChanged)
+{
+    auto& depth = depth_[static_cast<std::size_t>(side)];
+    if (depth.stale_)
+        return;
+
+    // Levels added or removed past the boundary of a full side do not change the top levels.
+    const bool withinDepth = side == Side::Buy ? price >= depth.boundary_ : price <= depth.boundary_;
+    if (!withinDepth && (depth.full_ || !levelChanged))
+        return;
+
+    if (levelChanged) {
+        depth.stale_ = true;
+        return;
+    }
+
+    if (isAdd)
+        depth.volume_ += quantity;
+    else
+        depth.volume_ -= quantity;
+}
+
+
+void OrderBook::RefreshDepth(Side side) const
+{
+    auto& depth = depth_[static_cast<std::size_t>(side)];
+    const auto& levelData = priceLevelMetaData_[static_cast<std::size_t>(side)];
+
+    auto Sum = [&depth, &levelData](const auto& levels)
+    {
+        depth = DepthData{ };
+        depth.stale_ = false;
+
+        std::size_t count = 0;
+        for (auto iterator = levels.begin(); iterator != levels.end() && count < AnalyticsLevels; ++iterator, ++count) {
+            depth.volume_ += levelData.at(iterator->first).quantity_;
+            depth.boundary_ = iterator->first;
+        }
+        depth.full_ = count == AnalyticsLevels;
+    };
+
+    if (side == Side::Buy)
+        Sum(bids_);
+    else
+        Sum(asks_);
+}
+
+
+BookAnalytics OrderBook::GetAnalytics() const
+{
+    const auto nan = std::numeric_limits<double>::quiet_NaN();
+
+    for (auto side : { Side::Buy, Side::Sell })
+        if (depth_[static_cast<std::size_t>(side)].stale_)
+            RefreshDepth(side);
+
+    AdvanceWindow();
+
+    BookAnalytics analytics{ };
+    analytics.bidDepth_ = depth_[static_cast<std::size_t>(Side::Buy)].volume_;
+    analytics.askDepth_ = depth_[static_cast<std::size_t>(Side::Sell)].volume_;
+
+    const double totalDepth = static_cast<double>(analytics.bidDepth_) + analytics.askDepth_;
+    analytics.imbalance_ = totalDepth > 0 ? (static_cast<double>(analytics.bidDepth_) - analytics.askDepth_) / totalDepth : 0.0;
+
+    analytics.microprice_ = nan;
+    if (!bids_.empty() && !asks_.empty()) {
+        const Price bestBid = bids_.begin()->first;
+        const Price bestAsk = asks_.begin()->first;
+        const double bidQuantity = priceLevelMetaData_[static_cast<std::size_t>(Side::Buy)].at(bestBid).quantity_;
+        const double askQuantity = priceLevelMetaData_[static_cast<std::size_t>(Side::Sell)].at(bestAsk).quantity_;
+        analytics.microprice_ = (bestBid * askQuantity + bestAsk * bidQuantity) / (bidQuantity + askQuantity);
+    }
+
+    analytics.sessionVolume_ = sessionVolume_;
+    analytics.sessionVwap_ = sessionVolume_ ? static_cast<double>(sessionNotional_) / sessionVolume_ : nan;
+    analytics.rollingVolume_ = windowVolume_;
+    analytics.rollingVwap_ = windowVolume_ ? static_cast<double>(windowNotional_) / windowVolume_ : nan;
+    return analytics;
 }
 
 
 bool OrderBook::CanFullyFill(Price price, Quantity quantity, Side side) const
 {
-    if (!CanMatch(side, price))
+    // Counts only the opposite side's limit orders at prices the order crosses. Pegged orders
+    // can only add to that, so an order that passes always fills completely, though one that
+    // needs pegged liquidity to fill is killed.
+    const Side restingSide = side == Side::Buy ? Side::Sell : Side::Buy;
+    const auto& levelData = priceLevelMetaData_[static_cast<std::size_t>(restingSide)];
+    Quantity available = 0;
+
+    auto Accumulate = [&levelData, &available, quantity](const auto& levels, auto crosses)
+    {
+        for (const auto& [levelPrice, _] : levels) {
+            if (!crosses(levelPrice))
+                return false;
+
+            available += levelData.at(levelPrice).quantity_;
+            if (available >= quantity)
+                return true;
+        }
         return false;
-    
+    };
+
+    if (side == Side::Buy)
+        return Accumulate(asks_, [price](Price levelPrice) { return levelPrice <= price; });
+    return Accumulate(bids_, [price](Price levelPrice) { return levelPrice >= price; });
 }
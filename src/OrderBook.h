@@ -1,18 +1,42 @@
 #pragma once
 
+#include <array>
+#include <chrono>
+#include <deque>
 #include <map>
 #include <unordered_map>
 #include <thread>
+#include <optional>
+#include <limits>
+#include <scoped_allocator>
 
 #include "Usings.h"
+#include "Arena.h"
 #include "Order.h"
 #include "Trade.h"
 #include "OrderModify.h"
 #include "OrderBookLevelInfos.h"
+#include "BookAnalytics.h"
+#include "AggressorExecution.h"
+#include "FillListener.h"
+#include "feed/MarketByOrderRing.h"
+#include "feed/MarketByOrderSnapshot.h"
 
 class OrderBook
 {
+public:
+
+    static constexpr std::size_t AnalyticsLevels = 5;
+    static constexpr std::chrono::seconds VwapWindow{ 60 };
+
 private:
+
+    template <typename Key, typename Value>
+    using HashMap = std::unordered_map<Key, Value, std::hash<Key>, std::equal_to<Key>, ArenaAllocator<std::pair<const Key, Value>>>;
+
+    // Levels hand their arena down to the order lists they hold.
+    template <typename Compare>
+    using Levels = std::map<Price, OrderPointers, Compare, std::scoped_allocator_adaptor<ArenaAllocator<std::pair<const Price, OrderPointers>>>>;
     
     struct OrderEntry
         {
@@ -24,8 +48,8 @@ private:
     // Stores meta data about each price level
     struct LevelData
         {
-            Price price_;
-            Quantity quantity_;
+            Price price_{ };
+            Quantity quantity_{ };
 
             enum class Action
             {
@@ -35,11 +59,71 @@ private:
             };
         };
 
-    std::map<Price, OrderPointers, std::greater<Price>> bids_;
-    std::map<Price, OrderPointers, std::less<Price>> asks_;
-    std::unordered_map<OrderId, OrderEntry> orders_;
+    // Volume resting in the top AnalyticsLevels levels of one side. Changes inside the tracked
+    // levels are applied as they happen; a level appearing or disappearing there marks it stale
+    // and it is re-summed, over at most AnalyticsLevels levels, on the next read.
+    struct DepthData
+        {
+            Quantity volume_{ };
+            Price boundary_{ };     // Worst price currently counted
+            bool full_{ false };    // Whether the side had AnalyticsLevels levels when summed
+            bool stale_{ true };
+        };
 
-    std::unordered_map<Price, LevelData> priceLevelMetaData_;
+    // Trades of one second of book time in the rolling VWAP window.
+    struct WindowBucket
+        {
+            std::int64_t second_{ };
+            std::int64_t notional_{ };
+            std::uint64_t volume_{ };
+        };
+
+    // The best resting order on one side and the price it would trade at.
+    struct MatchCandidate
+        {
+            Order* order_;
+            Price price_;
+        };
+
+    // All containers and orders made through MakeOrder draw from this arena, or from the
+    // default heap when it is null.
+    Arena* arena_{ nullptr };
+
+    Levels<std::greater<Price>> bids_;
+    Levels<std::less<Price>> asks_;
+    HashMap<OrderId, OrderEntry> orders_;
+
+    // Pegged orders per PegType (Primary, Midpoint), in levels keyed by their offset from the
+    // reference price. Offsets order exactly like prices, and effective prices are derived from
+    // the best limit prices when matching, so a touch move never touches these levels.
+    std::array<Levels<std::greater<Price>>, 2> bidPegs_;
+    std::array<Levels<std::less<Price>>, 2> askPegs_;
+    std::uint64_t nextSequence_{ };
+
+    FillListener* fillListener_{ nullptr };
+
+    // Market by order feed, events are only published while a ring is attached.
+    MarketByOrderRing* marketByOrderRing_{ nullptr };
+    std::uint64_t bookSequence_{ };
+
+    // Reused by the Trades returning overloads, so only the Trades themselves are allocated.
+    AggressorExecution execution_;
+
+    // Indexed by Side, a bid and an ask level can briefly share a price before they match.
+    std::array<HashMap<Price, LevelData>, 2> priceLevelMetaData_;
+
+    mutable std::array<DepthData, 2> depth_;
+    std::int64_t sessionNotional_{ };
+    std::uint64_t sessionVolume_{ };
+    // Book time is set by the caller, so a replay gets the rolling VWAP of its recorded times.
+    std::chrono::nanoseconds time_{ };
+    mutable std::array<WindowBucket, VwapWindow.count()> tradeWindow_{ };
+    mutable std::int64_t windowSecond_{ };     // Latest second the window has advanced to
+    mutable std::int64_t windowNotional_{ };
+    mutable std::uint64_t windowVolume_{ };
+
+    // Head of each participant's intrusive list of resting orders, used for mass cancels.
+    HashMap<ParticipantId, Order*> participantOrders_;
 
     std::mutex ordersMutex;
     std::thread ordersPruneThread;
@@ -47,22 +131,56 @@ private:
     void pruneGoodForDayOrders();
     void CancelOrders(OrderIds orderIds); 
     void CancelOrderInternal(OrderId orderId);
+    void InsertOrder(OrderPointer order);
+    OrderPointer EraseOrder(OrderId orderId);
+    void LinkParticipantOrder(Order* order);
+    void UnlinkParticipantOrder(Order* order);
 
     void OnOrderCancelled(OrderPointer order);
     void OnOrderAdded(OrderPointer order);
-    void OnOrderMatched(OrderPointer order);
-    void UpdateLevelData();
+    void OnOrderMatched(Side side, Price price, Quantity quantity);
+    void PublishMarketByOrder(MarketByOrderEventType type, const Order& order, Price price, Quantity quantity);
+    void OnTradeExecuted(Price price, Quantity quantity);
+    void UpdateLevelData(Side side, Price price, Quantity quantity, LevelData::Action action);
+    void UpdateDepth(Side side, Price price, Quantity quantity, bool isAdd, bool levelChanged);
+    void RefreshDepth(Side side) const;
+    std::int64_t AdvanceWindow() const;
 
     bool CanFullyFill(Price price, Quantity quantity, Side side) const;
     bool CanMatch(Side side, Price price) const;
-    Trades MatchOrders();
+    std::optional<Price> GetPegReferencePrice(Side side, PegType pegType) const;
+    std::optional<Price> GetEffectivePrice(const Order& order) const;
+    std::optional<MatchCandidate> GetBestResting(Side side) const;
+    void MatchOrders(OrderPointer order, AggressorExecution& execution);
+    void MatchCrossedPegs();
+    void FillResting(Order& order, Price price, Quantity quantity);
+    Trades ToTrades(const AggressorExecution& execution) const;
 
 public:
 
+    explicit OrderBook(Arena* arena = nullptr);
+
+    // Time the next trades are stamped with and the rolling VWAP window is read at.
+    void SetTime(std::chrono::nanoseconds time) { time_ = time; }
+    void SetFillListener(FillListener* fillListener) { fillListener_ = fillListener; }
+    void SetMarketByOrderRing(MarketByOrderRing* ring) { marketByOrderRing_ = ring; }
+
+    OrderPointer MakeOrder(OrderType orderType, OrderId orderId, Side side, Price price, Quantity quantity, ParticipantId participantId = { }) const;
+    OrderPointer MakeOrder(PegType pegType, OrderId orderId, Side side, Price pegOffset, Quantity quantity, ParticipantId participantId = { }) const;
     Trades AddOrder(OrderPointer order);
+    void AddOrder(OrderPointer order, AggressorExecution& execution);
     void CancelOrder(OrderId OrderId);
+    std::size_t MassCancel(ParticipantId participantId, std::optional<Side> side = std::nullopt,
+        Price minPrice = std::numeric_limits<Price>::min(), Price maxPrice = std::numeric_limits<Price>::max());
     Trades ModifyOrder(OrderModify order);
+    void ModifyOrder(OrderModify order, AggressorExecution& execution);
     OrderBookLevelInfos GetOrderInfos() const;
+    BookAnalytics GetAnalytics() const;
+    std::optional<Price> GetBestPrice(Side side) const;
+    Quantity GetLevelQuantity(Side side, Price price) const;
     std::size_t Size() const;
+    std::optional<ParticipantId> GetParticipantId(OrderId orderId) const;
+    std::uint64_t GetBookSequence() const { return bookSequence_; }
+    bool CopyOrders(MarketByOrderSnapshot& snapshot, std::size_t maxOrders) const;
 };
 
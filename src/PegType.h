@@ -0,0 +1,8 @@
+#pragma once
+
+enum class PegType
+{
+	None,
+	Primary,	// Tracks the best price on the order's own side
+	Midpoint,	// Tracks the midpoint of the best bid and ask
+};
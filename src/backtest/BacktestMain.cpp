@@ -0,0 +1,115 @@
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../gateway/MessageFactory.h"
+#include "EventStream.h"
+#include "Simulation.h"
+#include "WorkStealingPool.h"
+
+// Usage:
+//   backtest generate <file> [events]           Record a synthetic event stream
+//   backtest run <file> [runs] [threads]        Fan strategy parameter sets out over the stream
+
+namespace
+{
+    int Generate(const std::string& path, std::size_t count)
+    {
+        MessageFactory factory;
+        std::vector<OrderMessage> events;
+        events.reserve(count);
+
+        // Recorded events carry their time in nanoseconds in clientTimestamp_, here one millisecond apart.
+        for (std::size_t i = 0; i < count; ++i) {
+            events.push_back(factory.Next());
+            events.back().clientTimestamp_ = i * 1'000'000;
+        }
+
+        EventStream::Write(path, events);
+        std::cout << "wrote " << count << " events to " << path << std::endl;
+        return 0;
+    }
+
+    StrategyParameters ParametersFor(std::size_t run)
+    {
+        // Walk a grid of offset x size x requote interval, wrapping for large run counts.
+        return StrategyParameters{
+            static_cast<Price>(run % 5),
+            static_cast<Quantity>(10 * (1 + (run / 5) % 4)),
+            static_cast<std::size_t>(50 * (1 + (run / 20) % 5)),
+            500,
+        };
+    }
+
+    int Run(const std::string& path, std::size_t runs, std::size_t threads)
+    {
+        const EventStream stream{ path };
+        const auto events = stream.GetEvents();
+        std::vector<SimulationResult> results(runs);
+
+        const auto start = std::chrono::steady_clock::now();
+        {
+            WorkStealingPool pool{ threads };
+            for (std::size_t run = 0; run < runs; ++run) {
+                pool.Submit([events, run, &results]()
+                {
+                    // Each run owns its book and strategy, only the event stream is shared.
+                    Simulation simulation{ events, ParametersFor(run) };
+                    results[run] = simulation.Run();
+                });
+            }
+            pool.Wait();
+        }
+        const auto wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << "run,offset,size,interval,fills,filled,position,pnl,avg_queue_ahead,cpu_ms\n";
+        double cpu = 0;
+        for (std::size_t run = 0; run < runs; ++run) {
+            const auto& result = results[run];
+            const double runtime = std::chrono::duration<double, std::milli>(result.runtime_).count();
+            cpu += runtime / 1'000.0;
+
+            std::cout << run << ','
+                << result.parameters_.quoteOffset_ << ','
+                << result.parameters_.quoteSize_ << ','
+                << result.parameters_.requoteInterval_ << ','
+                << result.fills_ << ','
+                << result.filledQuantity_ << ','
+                << result.position_ << ','
+                << std::fixed << std::setprecision(2) << result.pnl_ << ','
+                << result.averageQueueAhead_ << ','
+                << runtime << std::defaultfloat << '\n';
+        }
+
+        std::cout << "events: " << events.size()
+            << "  runs: " << runs
+            << "  threads: " << threads
+            << "  wall: " << wall << "s"
+            << "  summed run cpu: " << cpu << "s"
+            << "  parallel speedup: " << (wall > 0 ? cpu / wall : 0.0) << std::endl;
+        return 0;
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    const std::string mode = argc > 1 ? argv[1] : "";
+
+    if (mode == "generate" && argc > 2)
+        return Generate(argv[2], argc > 3 ? std::stoull(argv[3]) : 1'000'000);
+
+    if (mode == "run" && argc > 2) {
+        const std::size_t runs = argc > 3 ? std::stoull(argv[3]) : 100;
+        const std::size_t threads = argc > 4 ? std::stoull(argv[4]) : std::max(1u, std::thread::hardware_concurrency());
+        return Run(argv[2], runs, threads);
+    }
+
+    std::cerr << "usage: backtest generate <file> [events]\n"
+        << "       backtest run <file> [runs] [threads]" << std::endl;
+    return 1;
+}
@@ -0,0 +1,60 @@
+#include <cerrno>
+#include <fstream>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "EventStream.h"
+
+
+EventStream::EventStream(const std::string& path)
+{
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::system_error(errno, std::generic_category(), "open " + path);
+
+    struct stat status{ };
+    if (fstat(fd, &status) < 0) {
+        close(fd);
+        throw std::system_error(errno, std::generic_category(), "fstat " + path);
+    }
+
+    mappedSize_ = static_cast<std::size_t>(status.st_size);
+    count_ = mappedSize_ / sizeof(OrderMessage);
+
+    if (mappedSize_) {
+        void* memory = mmap(nullptr, mappedSize_, PROT_READ, MAP_SHARED, fd, 0);
+        if (memory == MAP_FAILED) {
+            close(fd);
+            throw std::system_error(errno, std::generic_category(), "mmap " + path);
+        }
+
+        // Every simulation walks the stream front to back. Advice values are not flags, so each
+        // hint is its own call.
+        madvise(memory, mappedSize_, MADV_SEQUENTIAL);
+        madvise(memory, mappedSize_, MADV_WILLNEED);
+        events_ = static_cast<const OrderMessage*>(memory);
+    }
+
+    close(fd);
+}
+
+
+EventStream::~EventStream()
+{
+    if (events_)
+        munmap(const_cast<OrderMessage*>(events_), mappedSize_);
+}
+
+
+void EventStream::Write(const std::string& path, const std::vector<OrderMessage>& events)
+{
+    std::ofstream file{ path, std::ios::binary | std::ios::trunc };
+    if (!file)
+        throw std::logic_error("Cannot open " + path + " for writing.");
+
+    file.write(reinterpret_cast<const char*>(events.data()), static_cast<std::streamsize>(events.size() * sizeof(OrderMessage)));
+}
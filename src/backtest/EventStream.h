@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "../gateway/Protocol.h"
+
+// A recorded order flow: a file of OrderMessage records, the same fixed-size messages the
+// Gateway accepts. The file is mapped read-only once and every simulation replays straight
+// out of the shared mapping, so the stream is never copied per run.
+class EventStream
+{
+public:
+    explicit EventStream(const std::string& path);
+    ~EventStream();
+
+    EventStream(const EventStream&) = delete;
+    EventStream& operator=(const EventStream&) = delete;
+
+    std::span<const OrderMessage> GetEvents() const { return { events_, count_ }; }
+
+    static void Write(const std::string& path, const std::vector<OrderMessage>& events);
+
+private:
+    const OrderMessage* events_{ nullptr };
+    std::size_t count_{ };
+    std::size_t mappedSize_{ };
+};
@@ -0,0 +1,180 @@
+#include <algorithm>
+
+#if defined(__linux__)
+#include <time.h>
+#endif
+
+#include "Simulation.h"
+
+
+namespace
+{
+    // Runs share cores with each other, so time them by the CPU their own thread used.
+    std::chrono::nanoseconds ThreadCpuTime()
+    {
+#if defined(__linux__)
+        timespec time{ };
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+        return std::chrono::seconds{ time.tv_sec } + std::chrono::nanoseconds{ time.tv_nsec };
+#else
+        // Without a per-thread clock fall back to wall time.
+        return std::chrono::steady_clock::now().time_since_epoch();
+#endif
+    }
+}
+
+
+Simulation::Simulation(std::span<const OrderMessage> events, StrategyParameters parameters)
+    : events_{ events }
+    , parameters_{ parameters }
+{ }
+
+
+SimulationResult Simulation::Run()
+{
+    const auto start = ThreadCpuTime();
+
+    for (std::size_t i = 0; i < events_.size(); ++i) {
+        if (i % parameters_.requoteInterval_ == 0)
+            Requote();
+
+        Apply(events_[i]);
+    }
+
+    const auto runtime = ThreadCpuTime() - start;
+    const double mark = MarkPrice();
+
+    return SimulationResult{
+        parameters_,
+        fills_,
+        filledQuantity_,
+        position_,
+        static_cast<double>(cash_) + static_cast<double>(position_) * mark,
+        quotesPlaced_ ? static_cast<double>(queueAheadTotal_) / static_cast<double>(quotesPlaced_) : 0.0,
+        runtime,
+    };
+}
+
+
+void Simulation::Apply(const OrderMessage& event)
+{
+    const auto side = static_cast<Side>(event.side_);
+    orderBook_.SetTime(std::chrono::nanoseconds{ event.clientTimestamp_ });
+
+    switch (event.type_)
+    {
+    case MessageType::Add:
+        orderBook_.AddOrder(orderBook_.MakeOrder(static_cast<OrderType>(event.orderType_), event.orderId_,
+            side, event.price_, event.quantity_), execution_);
+        OnExecution();
+        break;
+    case MessageType::Modify:
+        orderBook_.ModifyOrder(OrderModify{ event.orderId_, side, event.price_, event.quantity_ }, execution_);
+        OnExecution();
+        break;
+    case MessageType::Cancel:
+        orderBook_.CancelOrder(event.orderId_);
+        break;
+    default:
+        break;
+    }
+
+    // Volume that left a quote's level without trading came from behind it, unless the level
+    // is now smaller than the volume the quote thought was ahead.
+    for (auto quoteSide : { Side::Buy, Side::Sell }) {
+        auto& quote = quotes_[static_cast<std::size_t>(quoteSide)];
+        if (quote.active_)
+            quote.queueAhead_ = std::min(quote.queueAhead_, orderBook_.GetLevelQuantity(quoteSide, quote.price_));
+    }
+}
+
+
+void Simulation::OnExecution()
+{
+    // The aggressor trades against the side it is not on, which is the quote that may fill.
+    const Side restingSide = execution_.GetSide() == Side::Buy ? Side::Sell : Side::Buy;
+    auto& quote = quotes_[static_cast<std::size_t>(restingSide)];
+
+    for (const auto& fill : execution_.GetFills()) {
+        if (!quote.active_)
+            return;
+
+        const bool tradedThrough = restingSide == Side::Buy ? fill.price_ < quote.price_ : fill.price_ > quote.price_;
+        if (tradedThrough) {
+            FillQuote(restingSide, fill.quantity_);
+            continue;
+        }
+
+        if (fill.price_ != quote.price_)
+            continue;
+
+        const Quantity consumedAhead = std::min(quote.queueAhead_, fill.quantity_);
+        quote.queueAhead_ -= consumedAhead;
+        if (fill.quantity_ > consumedAhead)
+            FillQuote(restingSide, fill.quantity_ - consumedAhead);
+    }
+}
+
+
+void Simulation::FillQuote(Side side, Quantity quantity)
+{
+    auto& quote = quotes_[static_cast<std::size_t>(side)];
+    const Quantity filled = std::min(quote.remaining_, quantity);
+    if (!filled)
+        return;
+
+    quote.remaining_ -= filled;
+    quote.active_ = quote.remaining_ > 0;
+
+    const auto notional = static_cast<std::int64_t>(quote.price_) * filled;
+    if (side == Side::Buy) {
+        position_ += filled;
+        cash_ -= notional;
+    }
+    else {
+        position_ -= filled;
+        cash_ += notional;
+    }
+
+    ++fills_;
+    filledQuantity_ += filled;
+}
+
+
+void Simulation::Requote()
+{
+    for (auto side : { Side::Buy, Side::Sell }) {
+        auto& quote = quotes_[static_cast<std::size_t>(side)];
+        quote.active_ = false;
+
+        const auto best = orderBook_.GetBestPrice(side);
+        if (!best)
+            continue;
+
+        const auto projected = position_ + (side == Side::Buy ? 1 : -1) * static_cast<std::int64_t>(parameters_.quoteSize_);
+        if (projected > parameters_.maxPosition_ || projected < -parameters_.maxPosition_)
+            continue;
+
+        // Join the back of the queue at the chosen level.
+        quote.active_ = true;
+        quote.price_ = side == Side::Buy ? *best - parameters_.quoteOffset_ : *best + parameters_.quoteOffset_;
+        quote.remaining_ = parameters_.quoteSize_;
+        quote.queueAhead_ = orderBook_.GetLevelQuantity(side, quote.price_);
+
+        queueAheadTotal_ += quote.queueAhead_;
+        ++quotesPlaced_;
+    }
+}
+
+
+double Simulation::MarkPrice() const
+{
+    const auto bestBid = orderBook_.GetBestPrice(Side::Buy);
+    const auto bestAsk = orderBook_.GetBestPrice(Side::Sell);
+
+    if (bestBid && bestAsk)
+        return (static_cast<double>(*bestBid) + *bestAsk) / 2.0;
+
+    const auto analytics = orderBook_.GetAnalytics();
+    return analytics.sessionVolume_ ? analytics.sessionVwap_ : 0.0;
+}
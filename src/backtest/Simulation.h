@@ -0,0 +1,70 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <span>
+
+#include "../OrderBook.h"
+#include "../gateway/Protocol.h"
+
+// Parameters of the passive quoting strategy a simulation runs against the recorded flow.
+struct StrategyParameters
+{
+    Price quoteOffset_;             // Ticks behind the best bid / ask to quote at
+    Quantity quoteSize_;
+    std::size_t requoteInterval_;   // Events between requotes
+    std::int64_t maxPosition_;      // Stop quoting the side that would grow the position past this
+};
+
+struct SimulationResult
+{
+    StrategyParameters parameters_;
+    std::size_t fills_;
+    std::uint64_t filledQuantity_;
+    std::int64_t position_;
+    double pnl_;                    // Cash plus position marked at the final midpoint
+    double averageQueueAhead_;      // Volume ahead of a quote when it was placed
+    std::chrono::nanoseconds runtime_;  // CPU time of the thread that ran the simulation
+};
+
+// Replays a recorded event stream through its own OrderBook while a strategy quotes virtual
+// orders alongside it. Virtual quotes never enter the book, they are filled by tracking their
+// queue position: they join the back of their level, trades at their price consume the volume
+// ahead first, cancels are assumed to come from behind unless the level has shrunk below the
+// volume still ahead, and trades through their price fill them outright.
+class Simulation
+{
+public:
+    Simulation(std::span<const OrderMessage> events, StrategyParameters parameters);
+
+    SimulationResult Run();
+
+private:
+    struct Quote
+    {
+        bool active_{ false };
+        Price price_{ };
+        Quantity remaining_{ };
+        Quantity queueAhead_{ };
+    };
+
+    std::span<const OrderMessage> events_;
+    StrategyParameters parameters_;
+    OrderBook orderBook_;
+    AggressorExecution execution_;
+    std::array<Quote, 2> quotes_;   // Indexed by Side
+
+    std::int64_t position_{ };
+    std::int64_t cash_{ };
+    std::size_t fills_{ };
+    std::uint64_t filledQuantity_{ };
+    std::uint64_t queueAheadTotal_{ };
+    std::size_t quotesPlaced_{ };
+
+    void Apply(const OrderMessage& event);
+    void OnExecution();
+    void Requote();
+    void FillQuote(Side side, Quantity quantity);
+    double MarkPrice() const;
+};
@@ -0,0 +1,107 @@
+#include <algorithm>
+
+#include "WorkStealingPool.h"
+
+
+WorkStealingPool::WorkStealingPool(std::size_t threadCount)
+{
+    threadCount = std::max<std::size_t>(threadCount, 1);
+
+    for (std::size_t i = 0; i < threadCount; ++i)
+        queues_.push_back(std::make_unique<Queue>());
+
+    for (std::size_t i = 0; i < threadCount; ++i)
+        workers_.emplace_back([this, i]() { WorkerLoop(i); });
+}
+
+
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::scoped_lock lock{ stateMutex_ };
+        stopping_ = true;
+    }
+    workAvailable_.notify_all();
+
+    for (auto& worker : workers_)
+        worker.join();
+}
+
+
+void WorkStealingPool::Submit(Task task)
+{
+    // Count the task as pending before a worker can see it, otherwise one could take and finish
+    // it first and let Wait return while it is still being submitted.
+    pending_.fetch_add(1);
+
+    // Spread submissions round robin, stealing evens out whatever imbalance remains. The task
+    // is counted as queued along with the push, so a worker woken for it finds it there.
+    auto& queue = *queues_[nextQueue_++ % queues_.size()];
+    {
+        std::scoped_lock lock{ queue.mutex_ };
+        queue.tasks_.push_back(std::move(task));
+        queued_.fetch_add(1);
+    }
+
+    // Passing through the mutex orders this wakeup after a worker's last look at queued_.
+    { std::scoped_lock lock{ stateMutex_ }; }
+    workAvailable_.notify_one();
+}
+
+
+void WorkStealingPool::Wait()
+{
+    std::unique_lock lock{ stateMutex_ };
+    allDone_.wait(lock, [this]() { return pending_.load() == 0; });
+}
+
+
+bool WorkStealingPool::TryTake(std::size_t index, Task& task)
+{
+    {
+        auto& own = *queues_[index];
+        std::scoped_lock lock{ own.mutex_ };
+        if (!own.tasks_.empty()) {
+            task = std::move(own.tasks_.front());
+            own.tasks_.pop_front();
+            queued_.fetch_sub(1);
+            return true;
+        }
+    }
+
+    for (std::size_t offset = 1; offset < queues_.size(); ++offset) {
+        auto& victim = *queues_[(index + offset) % queues_.size()];
+        std::scoped_lock lock{ victim.mutex_ };
+        if (!victim.tasks_.empty()) {
+            task = std::move(victim.tasks_.back());
+            victim.tasks_.pop_back();
+            queued_.fetch_sub(1);
+            return true;
+        }
+    }
+    return false;
+}
+
+
+void WorkStealingPool::WorkerLoop(std::size_t index)
+{
+    while (true) {
+        // Sleep only once there is nothing to take. queued_ drops with every take, so a worker
+        // that lost a task to another one goes back to sleep rather than spinning.
+        Task task;
+        if (!TryTake(index, task)) {
+            std::unique_lock lock{ stateMutex_ };
+            workAvailable_.wait(lock, [this]() { return stopping_ || queued_.load() > 0; });
+            if (stopping_ && queued_.load() == 0)
+                return;
+            continue;
+        }
+
+        task();
+
+        if (pending_.fetch_sub(1) == 1) {
+            std::scoped_lock lock{ stateMutex_ };
+            allDone_.notify_all();
+        }
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of workers, each with its own task deque. Workers take from the front of their
+// own deque and, when it runs dry, steal from the back of the others', so uneven simulation
+// lengths still keep every core busy.
+class WorkStealingPool
+{
+public:
+    using Task = std::function<void()>;
+
+    explicit WorkStealingPool(std::size_t threadCount);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    void Submit(Task task);
+    void Wait();
+    std::size_t GetThreadCount() const { return workers_.size(); }
+
+private:
+    struct Queue
+    {
+        std::mutex mutex_;
+        std::deque<Task> tasks_;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> workers_;
+    std::atomic<std::size_t> nextQueue_{ };
+
+    // Only sleeping and waking go through stateMutex_, taking and finishing tasks use the
+    // counters alone.
+    std::mutex stateMutex_;
+    std::condition_variable workAvailable_;
+    std::condition_variable allDone_;
+    std::atomic<std::size_t> queued_{ };     // Tasks waiting in any deque, changed under the deque's lock
+    std::atomic<std::size_t> pending_{ };    // Tasks submitted and not yet finished
+    bool stopping_{ false };                 // Guarded by stateMutex_
+
+    bool TryTake(std::size_t index, Task& task);
+    void WorkerLoop(std::size_t index);
+};
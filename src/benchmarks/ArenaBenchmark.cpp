@@ -0,0 +1,161 @@
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "../OrderBook.h"
+
+// Compares an OrderBook built on the Arena (huge pages, NUMA bound, pre-faulted) against one
+// on the default heap: time to stand the book up and load it, and dTLB misses while churning
+// orders across many price levels.
+// Usage: arena_benchmark [resting orders] [churn operations]
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Counts data TLB read misses for this thread, where perf events are available.
+    class TlbMissCounter
+    {
+    private:
+        int fd_{ -1 };
+
+    public:
+        TlbMissCounter()
+        {
+            perf_event_attr attributes{ };
+            attributes.type = PERF_TYPE_HW_CACHE;
+            attributes.size = sizeof(attributes);
+            attributes.config = PERF_COUNT_HW_CACHE_DTLB
+                | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            attributes.disabled = 1;
+            attributes.exclude_kernel = 1;
+            attributes.exclude_hv = 1;
+            fd_ = static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0));
+        }
+
+        ~TlbMissCounter()
+        {
+            if (fd_ >= 0)
+                close(fd_);
+        }
+
+        void Start()
+        {
+            if (fd_ < 0)
+                return;
+            ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+        }
+
+        std::optional<std::uint64_t> Stop()
+        {
+            if (fd_ < 0)
+                return std::nullopt;
+
+            ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+            std::uint64_t count{ };
+            if (read(fd_, &count, sizeof(count)) != sizeof(count))
+                return std::nullopt;
+            return count;
+        }
+    };
+
+    struct Result
+    {
+        double startupMs_;
+        double loadMs_;
+        double churnMs_;
+        std::optional<std::uint64_t> tlbMisses_;
+        bool hugePages_;
+        int node_;
+    };
+
+    double Milliseconds(Clock::duration duration)
+    {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+
+    Result Run(bool useArena, std::size_t restingOrders, std::size_t churn)
+    {
+        const auto startupBegin = Clock::now();
+
+        // Roughly a list node, a control block with the order, and an orders_ entry per order,
+        // plus headroom for the levels and hash buckets.
+        std::optional<Arena> arena;
+        if (useArena)
+            arena.emplace(restingOrders * 512);
+
+        OrderBook orderBook{ arena ? &*arena : nullptr };
+        const auto startupEnd = Clock::now();
+
+        // Non-crossing book spread over many levels so the churn touches a wide address range.
+        constexpr Price Levels = 5'000;
+        std::mt19937_64 random{ 7 };
+        OrderId nextOrderId = 1;
+
+        for (std::size_t i = 0; i < restingOrders; ++i) {
+            const auto side = i % 2 ? Side::Buy : Side::Sell;
+            const auto offset = static_cast<Price>(random() % Levels);
+            const Price price = side == Side::Buy ? 10'000 - offset : 10'001 + offset;
+            orderBook.AddOrder(orderBook.MakeOrder(OrderType::GoodTillCancel, nextOrderId++, side, price, 10));
+        }
+        const auto loadEnd = Clock::now();
+
+        TlbMissCounter counter;
+        counter.Start();
+        const auto churnBegin = Clock::now();
+
+        for (std::size_t i = 0; i < churn; ++i) {
+            orderBook.CancelOrder(1 + random() % (nextOrderId - 1));
+
+            const auto side = i % 2 ? Side::Buy : Side::Sell;
+            const auto offset = static_cast<Price>(random() % Levels);
+            const Price price = side == Side::Buy ? 10'000 - offset : 10'001 + offset;
+            orderBook.AddOrder(orderBook.MakeOrder(OrderType::GoodTillCancel, nextOrderId++, side, price, 10));
+        }
+
+        const auto churnEnd = Clock::now();
+        const auto tlbMisses = counter.Stop();
+
+        return Result{
+            Milliseconds(startupEnd - startupBegin),
+            Milliseconds(loadEnd - startupEnd),
+            Milliseconds(churnEnd - churnBegin),
+            tlbMisses,
+            arena && arena->UsesHugePages(),
+            arena ? arena->GetNode() : -1,
+        };
+    }
+
+    void Print(const char* name, const Result& result)
+    {
+        std::cout << name
+            << "  startup: " << result.startupMs_ << "ms"
+            << "  load: " << result.loadMs_ << "ms"
+            << "  churn: " << result.churnMs_ << "ms"
+            << "  dTLB misses: " << (result.tlbMisses_ ? std::to_string(*result.tlbMisses_) : std::string{ "n/a" })
+            << "  huge pages: " << (result.hugePages_ ? "yes" : "no")
+            << "  node: " << result.node_ << std::endl;
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    const std::size_t restingOrders = argc > 1 ? std::stoull(argv[1]) : 1'000'000;
+    const std::size_t churn = argc > 2 ? std::stoull(argv[2]) : 2'000'000;
+
+    Print("heap ", Run(false, restingOrders, churn));
+    Print("arena", Run(true, restingOrders, churn));
+    return 0;
+}
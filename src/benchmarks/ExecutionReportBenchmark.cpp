@@ -0,0 +1,70 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include "../OrderBook.h"
+#include "../gateway/Protocol.h"
+
+// Compares the Trades output of a sweeping market order with the aggregated AggressorExecution
+// written into a reused buffer: time per sweep, and the report slots and bytes the gateway
+// would send per sweep (a Fill report per trade against an ExecutionSummary and CompactFills).
+// Usage: execution_report_benchmark [resting orders per sweep] [sweeps]
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    void FillBook(OrderBook& orderBook, OrderId& nextOrderId, std::size_t restingOrders)
+    {
+        // Small orders, five to a level.
+        for (std::size_t i = 0; i < restingOrders; ++i)
+            orderBook.AddOrder(orderBook.MakeOrder(OrderType::GoodTillCancel, nextOrderId++, Side::Sell, static_cast<Price>(100 + i / 5), 1));
+    }
+
+    OrderPointer MakeSweep(OrderBook& orderBook, OrderId& nextOrderId, std::size_t restingOrders)
+    {
+        return orderBook.MakeOrder(OrderType::Market, nextOrderId++, Side::Buy, Constants::InvalidPrice, static_cast<Quantity>(restingOrders));
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    const std::size_t restingOrders = argc > 1 ? std::stoull(argv[1]) : 500;
+    const std::size_t sweeps = argc > 2 ? std::stoull(argv[2]) : 10'000;
+
+    OrderBook orderBook;
+    OrderId nextOrderId = 1;
+    Clock::duration tradesTime{ }, executionTime{ };
+    std::size_t tradesMessages = 0, executionMessages = 0, executionFills = 0;
+    AggressorExecution execution;
+
+    for (std::size_t i = 0; i < sweeps; ++i) {
+        FillBook(orderBook, nextOrderId, restingOrders);
+        auto order = MakeSweep(orderBook, nextOrderId, restingOrders);
+        const auto tradesStart = Clock::now();
+        const Trades trades = orderBook.AddOrder(order);
+        tradesTime += Clock::now() - tradesStart;
+        tradesMessages += trades.size();
+
+        FillBook(orderBook, nextOrderId, restingOrders);
+        order = MakeSweep(orderBook, nextOrderId, restingOrders);
+        const auto executionStart = Clock::now();
+        orderBook.AddOrder(order, execution);
+        executionTime += Clock::now() - executionStart;
+        const auto fillCount = static_cast<std::uint32_t>(execution.GetFills().size());
+        executionMessages += fillCount ? 1 + GetFillSlotCount(fillCount) : 0;
+        executionFills += fillCount;
+    }
+
+    auto PerSweep = [sweeps](auto value) { return static_cast<double>(value) / static_cast<double>(sweeps); };
+    auto Microseconds = [](Clock::duration duration) { return std::chrono::duration<double, std::micro>(duration).count(); };
+
+    std::cout << "trades     us/sweep: " << PerSweep(Microseconds(tradesTime))
+        << "  bytes/sweep: " << PerSweep(tradesMessages * sizeof(ExecutionReport))
+        << "  messages/sweep: " << PerSweep(tradesMessages) << std::endl;
+    std::cout << "execution  us/sweep: " << PerSweep(Microseconds(executionTime))
+        << "  bytes/sweep: " << PerSweep(executionMessages * sizeof(ExecutionReport))
+        << "  messages/sweep: " << PerSweep(executionMessages) << " (" << PerSweep(executionFills) << " fills)" << std::endl;
+    return 0;
+}
@@ -0,0 +1,192 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../OrderBook.h"
+#include "../feed/MarketByOrderReplica.h"
+#include "../gateway/MessageFactory.h"
+
+// A late joiner on a running book: the matcher applies synthetic flow over a deep book while a
+// consumer thread asks for a snapshot half way through, which the matcher copies a chunk at a
+// time between commands. The consumer then follows the ring to the end and its replica is
+// compared with the final book. Reports the pauses chunks caused against the time one copy of
+// the whole book takes.
+// Usage: market_by_order_benchmark [resting orders] [commands] [chunk size]
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    void Apply(OrderBook& orderBook, AggressorExecution& execution, const OrderMessage& message)
+    {
+        const auto side = static_cast<Side>(message.side_);
+
+        switch (message.type_)
+        {
+        case MessageType::Add:
+            orderBook.AddOrder(orderBook.MakeOrder(static_cast<OrderType>(message.orderType_), message.orderId_, side,
+                message.price_, message.quantity_), execution);
+            break;
+        case MessageType::Cancel:
+            orderBook.CancelOrder(message.orderId_);
+            break;
+        case MessageType::Modify:
+            orderBook.ModifyOrder(OrderModify{ message.orderId_, side, message.price_, message.quantity_ }, execution);
+            break;
+        }
+    }
+
+    bool Matches(const MarketByOrderReplica& replica, const MarketByOrderSnapshot& expected)
+    {
+        if (replica.Size() != expected.orders_.size())
+            return false;
+
+        for (const auto& order : expected.orders_) {
+            const auto* entry = replica.Find(order.orderId_);
+            if (!entry || entry->side_ != order.side_ || entry->price_ != order.price_ || entry->quantity_ != order.quantity_)
+                return false;
+        }
+        return true;
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    const std::size_t restingOrders = argc > 1 ? std::stoull(argv[1]) : 500'000;
+    const std::size_t commands = argc > 2 ? std::stoull(argv[2]) : 1'000'000;
+    const std::size_t chunkSize = argc > 3 ? std::stoull(argv[3]) : 256;
+
+    OrderBook orderBook;
+    MarketByOrderRing ring{ 1 << 22 };
+    orderBook.SetMarketByOrderRing(&ring);
+
+    // Deep resting liquidity well away from the flow around the mid, with ids the flow never uses.
+    OrderId nextOrderId = 1'000'000'000;
+    for (std::size_t i = 0; i < restingOrders; ++i) {
+        const auto side = i % 2 ? Side::Sell : Side::Buy;
+        const auto distance = static_cast<Price>(50 + (i / 2) % 400);
+        orderBook.AddOrder(orderBook.MakeOrder(OrderType::GoodTillCancel, nextOrderId++, side,
+            side == Side::Buy ? 1'000 - distance : 1'000 + distance, 10));
+    }
+
+    std::vector<OrderMessage> messages;
+    messages.reserve(commands);
+    MessageFactory factory;
+    for (std::size_t i = 0; i < commands; ++i)
+        messages.push_back(factory.Next());
+
+    std::atomic<MarketByOrderSnapshot*> request{ nullptr };
+    std::atomic<std::size_t> progress{ 0 };
+    std::atomic<bool> matching{ true };
+    std::vector<Clock::duration> chunkTimes;
+    Clock::duration snapshotTime{ };
+
+    MarketByOrderSnapshot snapshot;
+    MarketByOrderReplica replica;
+    std::size_t applied = 0;
+    bool lost = false;
+
+    std::thread matcher{ [&]()
+    {
+        AggressorExecution execution;
+        Clock::time_point requested{ };
+
+        // One chunk of a requested snapshot, false when none is pending.
+        auto CopyChunk = [&]()
+        {
+            auto* pending = request.load(std::memory_order_acquire);
+            if (!pending)
+                return false;
+
+            const auto start = Clock::now();
+            if (chunkTimes.empty())
+                requested = start;
+            const bool complete = orderBook.CopyOrders(*pending, chunkSize);
+            const auto end = Clock::now();
+
+            chunkTimes.push_back(end - start);
+            if (complete) {
+                snapshotTime = end - requested;
+                request.store(nullptr, std::memory_order_relaxed);
+            }
+            return true;
+        };
+
+        for (std::size_t i = 0; i < commands; ++i) {
+            Apply(orderBook, execution, messages[i]);
+            progress.store(i + 1, std::memory_order_relaxed);
+            CopyChunk();
+        }
+
+        // The joiner may only get to ask once the flow is over.
+        while (!snapshot.complete_.load(std::memory_order_acquire)) {
+            if (!CopyChunk())
+                std::this_thread::yield();
+        }
+        matching.store(false, std::memory_order_release);
+    } };
+
+    std::thread joiner{ [&]()
+    {
+        while (progress.load(std::memory_order_relaxed) < commands / 2)
+            std::this_thread::yield();
+
+        request.store(&snapshot, std::memory_order_release);
+        while (!snapshot.complete_.load(std::memory_order_acquire))
+            std::this_thread::yield();
+
+        replica.Load(snapshot);
+
+        MarketByOrderEvent event;
+        while (true) {
+            const bool finished = !matching.load(std::memory_order_acquire);
+            const auto read = ring.Read(replica.GetSequence() + 1, event);
+
+            if (read == RingRead::Ready) {
+                replica.Apply(event);
+                ++applied;
+            }
+            else if (read == RingRead::Lost) {
+                lost = true;
+                break;
+            }
+            else if (finished) {
+                break;
+            }
+            else {
+                std::this_thread::yield();
+            }
+        }
+    } };
+
+    matcher.join();
+    joiner.join();
+
+    MarketByOrderSnapshot expected;
+    const auto fullStart = Clock::now();
+    orderBook.CopyOrders(expected, orderBook.Size());
+    const auto fullCopy = Clock::now() - fullStart;
+
+    auto Microseconds = [](Clock::duration duration) { return std::chrono::duration<double, std::micro>(duration).count(); };
+
+    std::sort(chunkTimes.begin(), chunkTimes.end());
+    auto Percentile = [&chunkTimes](double percentile)
+    {
+        return chunkTimes[static_cast<std::size_t>(percentile * static_cast<double>(chunkTimes.size() - 1))];
+    };
+
+    std::cout << "resting orders at snapshot: " << snapshot.orders_.size() << "  chunks: " << chunkTimes.size() << " of " << chunkSize << std::endl;
+    std::cout << "chunk pause (us) p50: " << Microseconds(Percentile(0.5))
+        << " p99: " << Microseconds(Percentile(0.99))
+        << " max: " << Microseconds(chunkTimes.back()) << std::endl;
+    std::cout << "snapshot complete after us: " << Microseconds(snapshotTime)
+        << "  whole book in one copy us: " << Microseconds(fullCopy) << std::endl;
+    std::cout << "events applied after snapshot: " << applied
+        << "  replica matches book: " << (!lost && Matches(replica, expected) ? "yes" : "no") << std::endl;
+    return 0;
+}
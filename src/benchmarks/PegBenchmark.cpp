@@ -0,0 +1,57 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include "../OrderBook.h"
+
+// Measures the cost of moving the touch as the number of resting pegged orders grows. Pegged
+// orders are priced lazily off the best limit prices, so the cost should stay flat.
+// Usage: peg_benchmark [touch moves]
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    double NanosecondsPerTouchMove(std::size_t peggedOrders, std::size_t touchMoves)
+    {
+        OrderBook orderBook;
+        OrderId nextOrderId = 1;
+
+        // Ten limit levels a side around a 100 / 101 spread.
+        for (Price level = 0; level < 10; ++level) {
+            orderBook.AddOrder(orderBook.MakeOrder(OrderType::GoodTillCancel, nextOrderId++, Side::Buy, 99 - level, 100));
+            orderBook.AddOrder(orderBook.MakeOrder(OrderType::GoodTillCancel, nextOrderId++, Side::Sell, 101 + level, 100));
+        }
+
+        for (std::size_t i = 0; i < peggedOrders; ++i) {
+            const auto pegType = i % 2 ? PegType::Primary : PegType::Midpoint;
+            const auto side = (i / 2) % 2 ? Side::Buy : Side::Sell;
+            // At least a tick away from the reference, so the bid used below never trades with them.
+            const auto offset = static_cast<Price>(1 + i % 10);
+            orderBook.AddOrder(orderBook.MakeOrder(pegType, nextOrderId++, side, side == Side::Buy ? -offset : offset, 10));
+        }
+
+        // Improving the best bid and then pulling it moves the touch, and with it every
+        // primary and midpoint bid peg, twice per iteration.
+        const auto start = Clock::now();
+        for (std::size_t i = 0; i < touchMoves; ++i) {
+            const OrderId orderId = nextOrderId++;
+            orderBook.AddOrder(orderBook.MakeOrder(OrderType::GoodTillCancel, orderId, Side::Buy, 100, 10));
+            orderBook.CancelOrder(orderId);
+        }
+        const auto elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+        return elapsed / static_cast<double>(touchMoves * 2);
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    const std::size_t touchMoves = argc > 1 ? std::stoull(argv[1]) : 1'000'000;
+
+    for (std::size_t peggedOrders : { 0, 1'000, 10'000, 100'000, 1'000'000 })
+        std::cout << "pegged orders: " << peggedOrders
+            << "  ns per touch move: " << NanosecondsPerTouchMove(peggedOrders, touchMoves) << std::endl;
+    return 0;
+}
@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../OrderBook.h"
+#include "../gateway/MessageFactory.h"
+#include "../risk/RiskStage.h"
+
+// Runs the same synthetic flow through an OrderBook in batches, unchecked and behind a RiskStage,
+// and reports the cost per command of each along with the part of it spent in Check. The two
+// modes alternate for a few rounds on fresh books and the fastest round of each is reported.
+// Usage: risk_benchmark [commands] [batch size] [rounds]
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    constexpr ParticipantId Participants = 16;
+
+    struct Result
+    {
+        Clock::duration total_{ Clock::duration::max() };
+        Clock::duration check_{ };
+        std::size_t rejected_{ };
+    };
+
+    void Apply(OrderBook& orderBook, AggressorExecution& execution, const CommandBatch& batch, std::size_t index)
+    {
+        const auto side = static_cast<Side>(batch.GetSides()[index]);
+        const auto orderId = batch.GetOrderIds()[index];
+
+        switch (batch.GetTypes()[index])
+        {
+        case MessageType::Add:
+            orderBook.AddOrder(orderBook.MakeOrder(static_cast<OrderType>(batch.GetOrderTypes()[index]), orderId, side,
+                batch.GetPrices()[index], batch.GetQuantities()[index], batch.GetParticipantIds()[index]), execution);
+            break;
+        case MessageType::Cancel:
+            orderBook.CancelOrder(orderId);
+            break;
+        case MessageType::Modify:
+            orderBook.ModifyOrder(OrderModify{ orderId, side, batch.GetPrices()[index], batch.GetQuantities()[index] }, execution);
+            break;
+        }
+    }
+
+    std::optional<Price> GetReferencePrice(const OrderBook& orderBook)
+    {
+        const auto bid = orderBook.GetBestPrice(Side::Buy);
+        const auto ask = orderBook.GetBestPrice(Side::Sell);
+        if (bid && ask)
+            return (*bid + *ask) / 2;
+        return bid ? bid : ask;
+    }
+
+    // Decodes each batch into one reused CommandBatch, as the Gateway does per read, and runs it
+    // through the RiskStage first when one is given.
+    Result Run(const std::vector<OrderMessage>& messages, std::size_t batchSize, RiskStage* riskStage)
+    {
+        OrderBook orderBook;
+        if (riskStage)
+            orderBook.SetFillListener(riskStage);
+
+        CommandBatch batch;
+        AggressorExecution execution;
+        std::vector<RejectReason> reasons;
+        Result result;
+
+        const auto start = Clock::now();
+        for (std::size_t offset = 0; offset < messages.size(); offset += batchSize) {
+            batch.Clear();
+            const auto end = std::min(messages.size(), offset + batchSize);
+            for (std::size_t i = offset; i < end; ++i)
+                batch.Add(messages[i], static_cast<ParticipantId>(i % Participants));
+
+            if (riskStage) {
+                const auto checkStart = Clock::now();
+                riskStage->Check(batch, GetReferencePrice(orderBook), reasons);
+                result.check_ += Clock::now() - checkStart;
+            }
+
+            for (std::size_t index = 0; index < batch.Size(); ++index) {
+                if (riskStage && reasons[index] != RejectReason::None) {
+                    ++result.rejected_;
+                    continue;
+                }
+                Apply(orderBook, execution, batch, index);
+            }
+        }
+        result.total_ = Clock::now() - start;
+        return result;
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    const std::size_t commands = argc > 1 ? std::stoull(argv[1]) : 1'000'000;
+    const std::size_t batchSize = argc > 2 ? std::stoull(argv[2]) : 64;
+    const std::size_t rounds = argc > 3 ? std::stoull(argv[3]) : 5;
+
+    std::vector<OrderMessage> messages;
+    messages.reserve(commands);
+    MessageFactory factory;
+    for (std::size_t i = 0; i < commands; ++i)
+        messages.push_back(factory.Next());
+
+    const RiskLimits limits{ .priceBand_ = 100, .maxQuantity_ = 10'000, .maxNotional_ = 10'000'000, .maxPosition_ = 1'000'000 };
+    Result unchecked, checked;
+
+    for (std::size_t round = 0; round < rounds; ++round) {
+        const auto uncheckedRound = Run(messages, batchSize, nullptr);
+        unchecked = uncheckedRound.total_ < unchecked.total_ ? uncheckedRound : unchecked;
+
+        RiskStage riskStage{ limits };
+        const auto checkedRound = Run(messages, batchSize, &riskStage);
+        checked = checkedRound.total_ < checked.total_ ? checkedRound : checked;
+    }
+
+    auto PerCommand = [commands](Clock::duration duration)
+    {
+        return std::chrono::duration<double, std::nano>(duration).count() / static_cast<double>(commands);
+    };
+
+    std::cout << "unchecked  ns/command: " << PerCommand(unchecked.total_) << std::endl;
+    std::cout << "checked    ns/command: " << PerCommand(checked.total_)
+        << "  (check " << PerCommand(checked.check_) << ", rejected " << checked.rejected_ << ")" << std::endl;
+    std::cout << "overhead: " << 100.0 * (PerCommand(checked.total_) - PerCommand(unchecked.total_)) / PerCommand(unchecked.total_) << "%" << std::endl;
+    return 0;
+}
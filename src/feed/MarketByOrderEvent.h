@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+#include "../Side.h"
+#include "../Usings.h"
+
+enum class MarketByOrderEventType : std::uint8_t
+{
+	Added,		// quantity_ is the order's open quantity
+	Reduced,	// quantity_ is taken off by a modify, the order keeps its place in the queue
+	Executed,	// quantity_ traded at price_ against this resting order
+	Deleted,	// quantity_ is what remained when the order was cancelled
+};
+
+// One change to one resting limit order. sequence_ increases by one with every event an
+// OrderBook publishes, so consumers can detect gaps. An order reduced or executed down to
+// nothing leaves the book without a separate Deleted event.
+struct MarketByOrderEvent
+{
+    std::uint64_t sequence_;
+    OrderId orderId_;
+    Price price_;
+    Quantity quantity_;
+    Side side_;
+    MarketByOrderEventType type_;
+};
+
+static_assert(sizeof(MarketByOrderEvent) == 32 && std::is_trivially_copyable_v<MarketByOrderEvent>);
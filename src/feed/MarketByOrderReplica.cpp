@@ -0,0 +1,98 @@
+#include <format>
+#include <stdexcept>
+
+#include "MarketByOrderReplica.h"
+
+
+void MarketByOrderReplica::Load(const MarketByOrderSnapshot& snapshot)
+{
+    orders_.clear();
+    for (auto& levels : levels_)
+        levels.clear();
+
+    // An order moved while the snapshot was taken can be copied twice; the later copy, further
+    // along the walk, holds its current place.
+    for (const auto& entry : snapshot.orders_) {
+        if (const auto iterator = orders_.find(entry.orderId_); iterator != orders_.end())
+            Erase(iterator);
+        Insert(entry.orderId_, entry.side_, entry.price_, entry.quantity_, entry.sequence_);
+    }
+
+    sequence_ = snapshot.startSequence_;
+    consistentSequence_ = snapshot.endSequence_;
+}
+
+
+void MarketByOrderReplica::Apply(const MarketByOrderEvent& event)
+{
+    if (event.sequence_ != sequence_ + 1)
+        throw std::logic_error(std::format("Market by order event {} does not follow {}.", event.sequence_, sequence_));
+
+    sequence_ = event.sequence_;
+
+    // Orders copied into the snapshot after this event already include it. Orders that were
+    // not copied at all were either removed before the copy reached them, making any event for
+    // them other than Added moot, or are added by this event.
+    auto iterator = orders_.find(event.orderId_);
+    if (iterator != orders_.end() && event.sequence_ <= iterator->second.sequence_)
+        return;
+
+    switch (event.type_)
+    {
+    case MarketByOrderEventType::Added:
+        Insert(event.orderId_, event.side_, event.price_, event.quantity_, event.sequence_);
+        break;
+    case MarketByOrderEventType::Reduced:
+    case MarketByOrderEventType::Executed:
+        if (iterator == orders_.end())
+            break;
+        if (event.quantity_ >= iterator->second.quantity_) {
+            Erase(iterator);
+            break;
+        }
+        iterator->second.quantity_ -= event.quantity_;
+        iterator->second.sequence_ = event.sequence_;
+        break;
+    case MarketByOrderEventType::Deleted:
+        if (iterator != orders_.end())
+            Erase(iterator);
+        break;
+    }
+}
+
+
+const MarketByOrderReplica::Entry* MarketByOrderReplica::Find(OrderId orderId) const
+{
+    const auto iterator = orders_.find(orderId);
+    return iterator == orders_.end() ? nullptr : &iterator->second;
+}
+
+
+const std::list<OrderId>* MarketByOrderReplica::GetQueue(Side side, Price price) const
+{
+    const auto& levels = levels_[static_cast<std::size_t>(side)];
+    const auto level = levels.find(price);
+    return level == levels.end() ? nullptr : &level->second;
+}
+
+
+void MarketByOrderReplica::Insert(OrderId orderId, Side side, Price price, Quantity quantity, std::uint64_t sequence)
+{
+    auto& queue = levels_[static_cast<std::size_t>(side)][price];
+    queue.push_back(orderId);
+    orders_.insert({ orderId, Entry{ side, price, quantity, sequence, std::prev(queue.end()) } });
+}
+
+
+void MarketByOrderReplica::Erase(std::unordered_map<OrderId, Entry>::iterator iterator)
+{
+    const auto& entry = iterator->second;
+    auto& levels = levels_[static_cast<std::size_t>(entry.side_)];
+    const auto level = levels.find(entry.price_);
+
+    level->second.erase(entry.location_);
+    if (level->second.empty())
+        levels.erase(level);
+
+    orders_.erase(iterator);
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <array>
+#include <list>
+#include <map>
+#include <unordered_map>
+
+#include "MarketByOrderEvent.h"
+#include "MarketByOrderSnapshot.h"
+
+// A consumer's copy of the book's resting limit orders in queue order, built from a
+// MarketByOrderSnapshot and kept current by applying every event after its startSequence_.
+class MarketByOrderReplica
+{
+public:
+    struct Entry
+    {
+        Side side_;
+        Price price_;
+        Quantity quantity_;
+        std::uint64_t sequence_;    // Events up to this sequence are already reflected
+        std::list<OrderId>::iterator location_;
+    };
+
+    void Load(const MarketByOrderSnapshot& snapshot);
+
+    // Events must arrive in sequence without gaps, starting right after the snapshot's startSequence_.
+    void Apply(const MarketByOrderEvent& event);
+
+    // Whether the replica matches the book as of GetSequence(), true once every event up to
+    // the end of the snapshot it was loaded from has been applied.
+    bool IsConsistent() const { return sequence_ >= consistentSequence_; }
+    std::uint64_t GetSequence() const { return sequence_; }
+    std::size_t Size() const { return orders_.size(); }
+    const Entry* Find(OrderId orderId) const;
+    const std::list<OrderId>* GetQueue(Side side, Price price) const;
+
+private:
+    std::unordered_map<OrderId, Entry> orders_;
+    std::array<std::map<Price, std::list<OrderId>>, 2> levels_;     // Indexed by Side
+    std::uint64_t sequence_{ };
+    std::uint64_t consistentSequence_{ };
+
+    void Insert(OrderId orderId, Side side, Price price, Quantity quantity, std::uint64_t sequence);
+    void Erase(std::unordered_map<OrderId, Entry>::iterator iterator);
+};
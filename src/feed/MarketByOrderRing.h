@@ -0,0 +1,87 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <format>
+#include <stdexcept>
+#include <vector>
+
+#include "MarketByOrderEvent.h"
+
+enum class RingRead
+{
+    Ready,
+    Pending,    // Not published yet
+    Lost,       // Overwritten before it was read, the reader has to take a new snapshot
+};
+
+// Fixed-capacity broadcast ring the OrderBook publishes MarketByOrderEvents into. The single
+// writer never waits for readers: each slot is a sequence lock, so any number of readers on
+// other threads can follow the stream, and one that falls a full ring behind sees Lost rather
+// than blocking matching. All slots are allocated up front.
+class MarketByOrderRing
+{
+private:
+    static constexpr std::size_t Words = sizeof(MarketByOrderEvent) / sizeof(std::uint64_t);
+
+    struct Slot
+    {
+        std::atomic<std::uint64_t> sequence_{ };   // Sequence of the event held, 0 while being written
+        std::array<std::atomic<std::uint64_t>, Words> words_{ };
+    };
+
+    std::vector<Slot> slots_;
+    std::size_t mask_;
+    std::atomic<std::uint64_t> published_{ };
+
+public:
+    // Capacity must be a power of two.
+    explicit MarketByOrderRing(std::size_t capacity)
+        : slots_(capacity)
+        , mask_{ capacity - 1 }
+    {
+        if (capacity == 0 || (capacity & mask_) != 0)
+            throw std::logic_error(std::format("Ring capacity ({}) must be a power of two.", capacity));
+    }
+
+    // Called by the writer only, with sequences increasing by one from 1.
+    void Publish(const MarketByOrderEvent& event)
+    {
+        std::array<std::uint64_t, Words> words;
+        std::memcpy(words.data(), &event, sizeof(event));
+
+        auto& slot = slots_[event.sequence_ & mask_];
+        slot.sequence_.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (std::size_t i = 0; i < Words; ++i)
+            slot.words_[i].store(words[i], std::memory_order_relaxed);
+        slot.sequence_.store(event.sequence_, std::memory_order_release);
+        published_.store(event.sequence_, std::memory_order_release);
+    }
+
+    RingRead Read(std::uint64_t sequence, MarketByOrderEvent& event) const
+    {
+        if (sequence > published_.load(std::memory_order_acquire))
+            return RingRead::Pending;
+
+        const auto& slot = slots_[sequence & mask_];
+        if (slot.sequence_.load(std::memory_order_acquire) != sequence)
+            return RingRead::Lost;
+
+        std::array<std::uint64_t, Words> words;
+        for (std::size_t i = 0; i < Words; ++i)
+            words[i] = slot.words_[i].load(std::memory_order_relaxed);
+
+        // The writer may have started on the slot while it was copied.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence_.load(std::memory_order_relaxed) != sequence)
+            return RingRead::Lost;
+
+        std::memcpy(&event, words.data(), sizeof(event));
+        return RingRead::Ready;
+    }
+
+    std::uint64_t GetPublished() const { return published_.load(std::memory_order_acquire); }
+    std::size_t GetCapacity() const { return slots_.size(); }
+};
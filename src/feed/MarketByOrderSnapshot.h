@@ -0,0 +1,40 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <optional>
+
+#include "../Side.h"
+#include "../Usings.h"
+
+struct MarketByOrderSnapshotEntry
+{
+    OrderId orderId_;
+    Side side_;
+    Price price_;
+    Quantity quantity_;
+    std::uint64_t sequence_;    // Book sequence when the entry was copied, events up to it are already reflected
+};
+
+// Every resting limit order, bids then asks, each level in queue order. Filled a few orders at
+// a time by OrderBook::CopyOrders on the matching thread while the book keeps changing, so the
+// entries alone are not a point-in-time picture: applying the feed's events from
+// startSequence_ + 1 with MarketByOrderReplica makes it consistent once endSequence_ is passed.
+struct MarketByOrderSnapshot
+{
+    std::uint64_t startSequence_{ };
+    std::uint64_t endSequence_{ };
+    std::deque<MarketByOrderSnapshotEntry> orders_;  // Grows in blocks, never copying what a chunk already wrote
+
+    // Where the next CopyOrders call resumes, maintained by the OrderBook.
+    bool started_{ false };
+    Side side_{ Side::Buy };
+    std::optional<Price> price_;
+    std::uint64_t orderSequence_{ };     // Arrival sequence of the last order copied at price_, those before it there are copied
+    OrderId orderId_{ };                 // Last order visited at price_, resumed from directly while it rests
+    std::uint64_t orderIdSequence_{ };   // Its arrival sequence, telling it apart from an order re-added under its id
+
+    // Set with release once the last order is copied, so another thread can wait on it.
+    std::atomic<bool> complete_{ false };
+};
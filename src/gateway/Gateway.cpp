@@ -0,0 +1,486 @@
+#include <bit>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <system_error>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "Gateway.h"
+
+
+namespace
+{
+    void ThrowSystemError(const char* what)
+    {
+        throw std::system_error(errno, std::generic_category(), what);
+    }
+
+    bool IsWellFormed(const OrderMessage& message)
+    {
+        const bool hasSide = message.side_ == static_cast<std::uint8_t>(Side::Buy) || message.side_ == static_cast<std::uint8_t>(Side::Sell);
+
+        switch (message.type_)
+        {
+        case MessageType::Add:
+            return hasSide && message.quantity_ > 0 && message.orderType_ <= static_cast<std::uint8_t>(OrderType::Market);
+        case MessageType::Modify:
+            return hasSide && message.quantity_ > 0;
+        case MessageType::Cancel:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    void SetNonBlocking(int fd)
+    {
+        const int flags = fcntl(fd, F_GETFL, 0);
+        if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0)
+            ThrowSystemError("fcntl");
+    }
+}
+
+
+Gateway::Gateway(std::uint16_t port, std::optional<RiskLimits> riskLimits)
+{
+    orderBook_.SetFillListener(this);
+    if (riskLimits)
+        riskStage_.emplace(*riskLimits);
+
+    listenFd_ = socket(AF_INET, SOCK_STREAM, 0);
+    if (listenFd_ < 0)
+        ThrowSystemError("socket");
+
+    const int enable = 1;
+    setsockopt(listenFd_, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+
+    sockaddr_in address{ };
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port);
+
+    if (bind(listenFd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0)
+        ThrowSystemError("bind");
+
+    if (listen(listenFd_, SOMAXCONN) < 0)
+        ThrowSystemError("listen");
+
+    SetNonBlocking(listenFd_);
+
+    epollFd_ = epoll_create1(0);
+    if (epollFd_ < 0)
+        ThrowSystemError("epoll_create1");
+
+    epoll_event event{ };
+    event.events = EPOLLIN;
+    event.data.fd = listenFd_;
+    if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, listenFd_, &event) < 0)
+        ThrowSystemError("epoll_ctl");
+}
+
+
+Gateway::~Gateway()
+{
+    for (auto& [fd, _] : connections_)
+        close(fd);
+
+    if (epollFd_ >= 0)
+        close(epollFd_);
+
+    if (listenFd_ >= 0)
+        close(listenFd_);
+}
+
+
+void Gateway::Run()
+{
+    running_ = true;
+    epoll_event events[MaxEvents];
+
+    while (running_) {
+        const int count = epoll_wait(epollFd_, events, MaxEvents, 100);
+        if (count < 0) {
+            if (errno == EINTR)
+                continue;
+            ThrowSystemError("epoll_wait");
+        }
+
+        orderBook_.SetTime(std::chrono::steady_clock::now().time_since_epoch());
+
+        for (int i = 0; i < count; ++i) {
+            const int fd = events[i].data.fd;
+
+            if (fd == listenFd_) {
+                Accept();
+                continue;
+            }
+
+            // The connection may have been closed earlier in this batch.
+            if (!connections_.contains(fd))
+                continue;
+
+            auto& connection = connections_.at(fd);
+
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                Close(connection);
+                continue;
+            }
+
+            if (events[i].events & EPOLLOUT)
+                OnWritable(connection);
+
+            if (connections_.contains(fd) && (events[i].events & EPOLLIN))
+                OnReadable(connection);
+
+            FlushNotified();
+        }
+    }
+}
+
+
+void Gateway::Accept()
+{
+    while (true) {
+        const int fd = accept(listenFd_, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+                return;
+            ThrowSystemError("accept");
+        }
+
+        SetNonBlocking(fd);
+        const int enable = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+
+        epoll_event event{ };
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &event) < 0) {
+            close(fd);
+            ThrowSystemError("epoll_ctl");
+        }
+
+        auto& connection = connections_[fd];
+        connection.fd_ = fd;
+        connection.participantId_ = nextParticipantId_++;
+        participantConnections_[connection.participantId_] = fd;
+        connection.inbound_.resize(InboundBufferSize);
+        connection.reports_.reserve(InboundBufferSize / sizeof(OrderMessage));
+    }
+}
+
+
+void Gateway::OnReadable(Connection& connection)
+{
+    // Drain everything the socket has buffered, decoding whole messages as the buffer fills,
+    // then answer the entire batch with a single flush.
+    while (true) {
+        const ssize_t received = read(connection.fd_,
+            connection.inbound_.data() + connection.inboundSize_,
+            connection.inbound_.size() - connection.inboundSize_);
+
+        if (received == 0) {
+            Close(connection);
+            return;
+        }
+
+        if (received < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                break;
+            Close(connection);
+            return;
+        }
+
+        connection.inboundSize_ += static_cast<std::size_t>(received);
+
+        std::size_t offset = 0;
+        while (connection.inboundSize_ - offset >= sizeof(OrderMessage)) {
+            OrderMessage message;
+            std::memcpy(&message, connection.inbound_.data() + offset, sizeof(message));
+            offset += sizeof(OrderMessage);
+
+            // Side and order type index the book's arrays, so malformed messages never reach it.
+            // The batch so far is processed first to keep reports in message order.
+            if (!IsWellFormed(message)) {
+                ProcessBatch(connection);
+                Reject(connection, message, RejectReason::Malformed);
+                continue;
+            }
+            batch_.Add(message, connection.participantId_);
+        }
+
+        ProcessBatch(connection);
+
+        // Keep any partial message at the front of the buffer for the next read.
+        connection.inboundSize_ -= offset;
+        if (connection.inboundSize_ && offset)
+            std::memmove(connection.inbound_.data(), connection.inbound_.data() + offset, connection.inboundSize_);
+    }
+
+    if (!Flush(connection))
+        Close(connection);
+}
+
+
+void Gateway::OnWritable(Connection& connection)
+{
+    if (!Flush(connection))
+        Close(connection);
+}
+
+
+void Gateway::Reject(Connection& connection, const OrderMessage& message, RejectReason reason)
+{
+    connection.reports_.push_back(ExecutionReport{ ReportType::Reject, { static_cast<std::uint8_t>(reason) },
+        message.price_, message.quantity_, { }, message.orderId_, message.clientTimestamp_ });
+}
+
+
+void Gateway::ProcessBatch(Connection& connection)
+{
+    if (batch_.Empty())
+        return;
+
+    if (riskStage_)
+        riskStage_->Check(batch_, GetReferencePrice(), rejectReasons_);
+
+    const auto& types = batch_.GetTypes();
+    for (std::size_t index = 0; index < batch_.Size(); ++index) {
+        auto reason = riskStage_ ? rejectReasons_[index] : RejectReason::None;
+
+        // Ownership is checked as each command runs, earlier ones in the batch may have added
+        // or removed the order. The book would drop an Add of a resting id without a word.
+        if (reason == RejectReason::None) {
+            const auto owner = orderBook_.GetParticipantId(batch_.GetOrderIds()[index]);
+            if (types[index] == MessageType::Add && owner)
+                reason = RejectReason::DuplicateOrder;
+            else if (types[index] != MessageType::Add && owner != connection.participantId_)
+                reason = RejectReason::UnknownOrder;
+        }
+
+        if (reason != RejectReason::None) {
+            connection.reports_.push_back(ExecutionReport{ ReportType::Reject, { static_cast<std::uint8_t>(reason) },
+                batch_.GetPrices()[index], batch_.GetQuantities()[index], { },
+                batch_.GetOrderIds()[index], batch_.GetClientTimestamps()[index] });
+            continue;
+        }
+
+        ProcessCommand(connection, index);
+    }
+
+    batch_.Clear();
+}
+
+
+void Gateway::ProcessCommand(Connection& connection, std::size_t index)
+{
+    const auto type = batch_.GetTypes()[index];
+    const auto side = static_cast<Side>(batch_.GetSides()[index]);
+    const auto price = batch_.GetPrices()[index];
+    const auto quantity = batch_.GetQuantities()[index];
+    const auto orderId = batch_.GetOrderIds()[index];
+    const auto clientTimestamp = batch_.GetClientTimestamps()[index];
+
+    connection.reports_.push_back(ExecutionReport{ ReportType::Ack, { }, price, quantity, { }, orderId, clientTimestamp });
+
+    switch (type)
+    {
+    case MessageType::Add:
+    {
+        auto order = orderBook_.MakeOrder(static_cast<OrderType>(batch_.GetOrderTypes()[index]), orderId,
+            side, price, quantity, connection.participantId_);
+        orderBook_.AddOrder(order, execution_);
+        AddFillReports(connection, clientTimestamp);
+    }
+    break;
+    case MessageType::Cancel:
+        orderBook_.CancelOrder(orderId);
+        break;
+    case MessageType::Modify:
+        orderBook_.ModifyOrder(OrderModify{ orderId, side, price, quantity }, execution_);
+        AddFillReports(connection, clientTimestamp);
+        break;
+    }
+}
+
+
+void Gateway::AddFillReports(Connection& connection, std::uint64_t clientTimestamp)
+{
+    // The aggressor's fills as one summary and packed fill records, resting orders hear of
+    // theirs through OnFill.
+    const auto& fills = execution_.GetFills();
+    if (fills.empty())
+        return;
+
+    const ExecutionSummary summary{ ReportType::Execution, { }, static_cast<std::uint32_t>(fills.size()),
+        execution_.GetFilledQuantity(), execution_.GetLevelsTouched(), execution_.GetOrderId(), clientTimestamp };
+    connection.reports_.push_back(std::bit_cast<ExecutionReport>(summary));
+
+    for (std::size_t i = 0; i < fills.size(); i += 2) {
+        CompactFillSlot slot{ };
+        for (std::size_t j = 0; j < slot.size() && i + j < fills.size(); ++j)
+            slot[j] = CompactFill{ fills[i + j].passiveOrderId_, fills[i + j].price_, fills[i + j].quantity_ };
+        connection.reports_.push_back(std::bit_cast<ExecutionReport>(slot));
+    }
+}
+
+
+void Gateway::OnAccept(const Order& order)
+{
+    if (riskStage_)
+        riskStage_->OnAccept(order);
+}
+
+
+void Gateway::OnFill(const Order& aggressor, const Order& resting, Price price, Quantity quantity)
+{
+    if (riskStage_)
+        riskStage_->OnFill(aggressor, resting, price, quantity);
+
+    AddRestingFillReport(resting, price, quantity);
+}
+
+
+void Gateway::OnCrossedFill(const Order& buy, const Order& sell, Price price, Quantity quantity)
+{
+    if (riskStage_)
+        riskStage_->OnCrossedFill(buy, sell, price, quantity);
+
+    AddRestingFillReport(buy, price, quantity);
+    AddRestingFillReport(sell, price, quantity);
+}
+
+
+void Gateway::AddRestingFillReport(const Order& order, Price price, Quantity quantity)
+{
+    const auto owner = participantConnections_.find(order.GetParticipantId());
+    if (owner == participantConnections_.end())
+        return;
+
+    auto& connection = connections_.at(owner->second);
+    if (connection.reports_.empty())
+        notified_.push_back(connection.fd_);
+    connection.reports_.push_back(ExecutionReport{ ReportType::Fill, { }, price, quantity, { }, order.GetOrderId(), { } });
+}
+
+
+void Gateway::OnCancel(const Order& order, Quantity quantity)
+{
+    if (riskStage_)
+        riskStage_->OnCancel(order, quantity);
+}
+
+
+std::optional<Price> Gateway::GetReferencePrice() const
+{
+    // The mid when both sides are quoted, otherwise whichever touch exists.
+    const auto bid = orderBook_.GetBestPrice(Side::Buy);
+    const auto ask = orderBook_.GetBestPrice(Side::Sell);
+
+    if (bid && ask)
+        return (*bid + *ask) / 2;
+    return bid ? bid : ask;
+}
+
+
+void Gateway::FlushNotified()
+{
+    for (const int fd : notified_) {
+        const auto iterator = connections_.find(fd);
+        if (iterator != connections_.end() && !Flush(iterator->second))
+            Close(iterator->second);
+    }
+    notified_.clear();
+}
+
+
+bool Gateway::Flush(Connection& connection)
+{
+    if (connection.reports_.empty() && connection.pending_.empty())
+        return true;
+
+    ReportBatchHeader header{ static_cast<std::uint32_t>(connection.reports_.size()), 0 };
+
+    iovec buffers[3];
+    int bufferCount = 0;
+
+    if (!connection.pending_.empty())
+        buffers[bufferCount++] = iovec{ connection.pending_.data(), connection.pending_.size() };
+
+    if (!connection.reports_.empty()) {
+        buffers[bufferCount++] = iovec{ &header, sizeof(header) };
+        buffers[bufferCount++] = iovec{ connection.reports_.data(), connection.reports_.size() * sizeof(ExecutionReport) };
+    }
+
+    ssize_t written;
+    do {
+        written = writev(connection.fd_, buffers, bufferCount);
+    } while (written < 0 && errno == EINTR);
+
+    if (written < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK)
+            return false;
+        written = 0;
+    }
+
+    // Whatever the socket did not accept is kept, in order, for the next EPOLLOUT.
+    std::vector<char> unsent;
+    auto remaining = static_cast<std::size_t>(written);
+    for (int i = 0; i < bufferCount; ++i) {
+        const auto* base = static_cast<const char*>(buffers[i].iov_base);
+        const auto length = buffers[i].iov_len;
+
+        if (remaining >= length) {
+            remaining -= length;
+            continue;
+        }
+
+        unsent.insert(unsent.end(), base + remaining, base + length);
+        remaining = 0;
+    }
+
+    // A client this far behind has stopped reading, holding more for it only grows the gateway.
+    if (unsent.size() > MaxPendingBytes)
+        return false;
+
+    connection.pending_.swap(unsent);
+    connection.reports_.clear();
+    SetWriteInterest(connection, !connection.pending_.empty());
+    return true;
+}
+
+
+void Gateway::SetWriteInterest(Connection& connection, bool enabled)
+{
+    if (connection.writeInterest_ == enabled)
+        return;
+
+    connection.writeInterest_ = enabled;
+    epoll_event event{ };
+    event.events = enabled ? EPOLLIN | EPOLLOUT : EPOLLIN;
+    event.data.fd = connection.fd_;
+    epoll_ctl(epollFd_, EPOLL_CTL_MOD, connection.fd_, &event);
+}
+
+
+void Gateway::Close(Connection& connection)
+{
+    // A disconnected client must not leave orders behind in the book.
+    orderBook_.MassCancel(connection.participantId_);
+
+    const int fd = connection.fd_;
+    participantConnections_.erase(connection.participantId_);
+    epoll_ctl(epollFd_, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    connections_.erase(fd);
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "../OrderBook.h"
+#include "../risk/RiskStage.h"
+#include "Protocol.h"
+
+// Single-threaded TCP order-entry gateway in front of an OrderBook.
+// Each epoll wakeup drains every readable socket, runs all complete messages through the
+// book and answers the whole batch with one vectored write per connection. When risk limits
+// are given, each read's messages are checked together by a RiskStage before any of them match.
+// Connections may only cancel or modify their own orders, and hear of fills on both sides.
+class Gateway : public FillListener
+{
+private:
+
+    struct Connection
+    {
+        int fd_{ -1 };
+        ParticipantId participantId_{ };
+        std::vector<char> inbound_;
+        std::size_t inboundSize_{ };
+        std::vector<char> pending_;     // Bytes a previous write could not send yet
+        std::vector<ExecutionReport> reports_;
+        bool writeInterest_{ false };
+    };
+
+    static constexpr std::size_t InboundBufferSize = 64 * 1024;
+    static constexpr std::size_t MaxPendingBytes = 4 * 1024 * 1024;   // Unsent reports before a client that stopped reading is dropped
+    static constexpr int MaxEvents = 64;
+    static constexpr std::size_t ArenaCapacity = 256 * 1024 * 1024;
+
+    // Constructed on the thread that runs the gateway, so the book's memory is local to it.
+    Arena arena_{ ArenaCapacity };
+    OrderBook orderBook_{ &arena_ };
+    AggressorExecution execution_;
+    std::optional<RiskStage> riskStage_;
+    CommandBatch batch_;
+    std::vector<RejectReason> rejectReasons_;
+    int listenFd_{ -1 };
+    int epollFd_{ -1 };
+    std::unordered_map<int, Connection> connections_;
+    std::unordered_map<ParticipantId, int> participantConnections_;
+    std::vector<int> notified_;     // Connections handed passive fills since they were last flushed
+    ParticipantId nextParticipantId_{ 1 };
+    std::atomic<bool> running_{ false };
+
+    void Accept();
+    void OnReadable(Connection& connection);
+    void OnWritable(Connection& connection);
+    void Reject(Connection& connection, const OrderMessage& message, RejectReason reason);
+    void ProcessBatch(Connection& connection);
+    void ProcessCommand(Connection& connection, std::size_t index);
+    void AddFillReports(Connection& connection, std::uint64_t clientTimestamp);
+    void AddRestingFillReport(const Order& order, Price price, Quantity quantity);
+    std::optional<Price> GetReferencePrice() const;
+    void FlushNotified();
+    bool Flush(Connection& connection);
+    void SetWriteInterest(Connection& connection, bool enabled);
+    void Close(Connection& connection);
+
+public:
+
+    explicit Gateway(std::uint16_t port, std::optional<RiskLimits> riskLimits = std::nullopt);
+    ~Gateway();
+
+    Gateway(const Gateway&) = delete;
+    Gateway& operator=(const Gateway&) = delete;
+
+    void OnAccept(const Order& order) override;
+    void OnFill(const Order& aggressor, const Order& resting, Price price, Quantity quantity) override;
+    void OnCrossedFill(const Order& buy, const Order& sell, Price price, Quantity quantity) override;
+    void OnCancel(const Order& order, Quantity quantity) override;
+
+    void Run();
+    void Stop() { running_ = false; }
+};
@@ -0,0 +1,37 @@
+#include <csignal>
+#include <iostream>
+#include <string>
+
+#include "Gateway.h"
+
+namespace
+{
+    Gateway* runningGateway = nullptr;
+
+    void OnSignal(int)
+    {
+        if (runningGateway)
+            runningGateway->Stop();
+    }
+}
+
+// Usage: gateway [port] [unchecked]
+int main(int argc, char** argv)
+{
+    const auto port = static_cast<std::uint16_t>(argc > 1 ? std::stoi(argv[1]) : 9000);
+    const bool unchecked = argc > 2 && std::string{ argv[2] } == "unchecked";
+
+    std::optional<RiskLimits> riskLimits;
+    if (!unchecked)
+        riskLimits = RiskLimits{ .priceBand_ = 100, .maxQuantity_ = 10'000, .maxNotional_ = 10'000'000, .maxPosition_ = 1'000'000 };
+
+    Gateway gateway{ port, riskLimits };
+    runningGateway = &gateway;
+    std::signal(SIGINT, OnSignal);
+    std::signal(SIGTERM, OnSignal);
+
+    std::cout << "gateway listening on 127.0.0.1:" << port << std::endl;
+    gateway.Run();
+    std::cout << "gateway stopped" << std::endl;
+    return 0;
+}
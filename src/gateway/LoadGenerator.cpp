@@ -0,0 +1,173 @@
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "MessageFactory.h"
+#include "Protocol.h"
+
+// Drives a Gateway at a fixed message rate and reports Ack (or Reject) round-trip latency percentiles.
+// Usage: loadgen [host] [port] [messages per second] [seconds]
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    std::uint64_t Now()
+    {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count());
+    }
+
+    int Connect(const std::string& host, std::uint16_t port)
+    {
+        const int fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0)
+            throw std::system_error(errno, std::generic_category(), "socket");
+
+        sockaddr_in address{ };
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        if (inet_pton(AF_INET, host.c_str(), &address.sin_addr) != 1)
+            throw std::logic_error("Invalid host address.");
+
+        if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0)
+            throw std::system_error(errno, std::generic_category(), "connect");
+
+        const int enable = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+        return fd;
+    }
+
+    bool ReadExactly(int fd, void* destination, std::size_t size)
+    {
+        auto* bytes = static_cast<char*>(destination);
+        while (size) {
+            const ssize_t received = read(fd, bytes, size);
+            if (received <= 0)
+                return false;
+            bytes += received;
+            size -= static_cast<std::size_t>(received);
+        }
+        return true;
+    }
+
+    void PrintPercentiles(std::vector<std::uint64_t>& latencies)
+    {
+        if (latencies.empty()) {
+            std::cout << "no acks received" << std::endl;
+            return;
+        }
+
+        std::sort(latencies.begin(), latencies.end());
+        auto At = [&latencies](double percentile)
+        {
+            const auto index = static_cast<std::size_t>(percentile * static_cast<double>(latencies.size() - 1));
+            return latencies[index] / 1'000.0;
+        };
+
+        std::cout << "acks: " << latencies.size() << "\n"
+            << "round trip (us) p50: " << At(0.50)
+            << " p90: " << At(0.90)
+            << " p99: " << At(0.99)
+            << " p99.9: " << At(0.999)
+            << " max: " << latencies.back() / 1'000.0 << std::endl;
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    const std::string host = argc > 1 ? argv[1] : "127.0.0.1";
+    const auto port = static_cast<std::uint16_t>(argc > 2 ? std::stoi(argv[2]) : 9000);
+    const auto rate = static_cast<std::uint64_t>(argc > 3 ? std::stoull(argv[3]) : 100'000);
+    const auto seconds = static_cast<std::uint64_t>(argc > 4 ? std::stoull(argv[4]) : 5);
+
+    const int fd = Connect(host, port);
+    const std::uint64_t total = rate * seconds;
+
+    std::vector<std::uint64_t> latencies;
+    latencies.reserve(total);
+    std::atomic<std::uint64_t> acks{ 0 };
+
+    std::thread receiver{ [fd, &latencies, &acks]()
+    {
+        ReportBatchHeader header;
+        std::vector<ExecutionReport> reports;
+
+        while (ReadExactly(fd, &header, sizeof(header))) {
+            reports.resize(header.count_);
+            if (!ReadExactly(fd, reports.data(), reports.size() * sizeof(ExecutionReport)))
+                break;
+
+            const auto now = Now();
+            for (std::size_t i = 0; i < reports.size(); ++i) {
+                const auto& report = reports[i];
+                if (report.type_ == ReportType::Execution)
+                    i += GetFillSlotCount(std::bit_cast<ExecutionSummary>(report).fillCount_);
+                if (report.type_ != ReportType::Ack && report.type_ != ReportType::Reject)
+                    continue;
+                latencies.push_back(now - report.clientTimestamp_);
+                acks.fetch_add(1, std::memory_order_release);
+            }
+        }
+    } };
+
+    // Messages are paced against a fixed schedule; when the sender falls behind, everything
+    // that is due goes out in a single write, the way a busy client would coalesce them.
+    MessageFactory factory;
+    std::vector<OrderMessage> batch;
+    const auto interval = std::chrono::nanoseconds{ 1'000'000'000 / std::max<std::uint64_t>(rate, 1) };
+    const auto start = Clock::now();
+    std::uint64_t sent = 0;
+
+    while (sent < total) {
+        const auto due = std::min<std::uint64_t>(total, static_cast<std::uint64_t>((Clock::now() - start) / interval) + 1);
+        if (due <= sent) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        batch.clear();
+        const auto timestamp = Now();
+        for (; sent < due; ++sent) {
+            auto message = factory.Next();
+            message.clientTimestamp_ = timestamp;
+            batch.push_back(message);
+        }
+
+        const auto* bytes = reinterpret_cast<const char*>(batch.data());
+        std::size_t remaining = batch.size() * sizeof(OrderMessage);
+        while (remaining) {
+            const ssize_t written = write(fd, bytes, remaining);
+            if (written < 0)
+                throw std::system_error(errno, std::generic_category(), "write");
+            bytes += written;
+            remaining -= static_cast<std::size_t>(written);
+        }
+    }
+
+    const auto deadline = Clock::now() + std::chrono::seconds{ 5 };
+    while (acks.load(std::memory_order_acquire) < total && Clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds{ 1 });
+
+    shutdown(fd, SHUT_RDWR);
+    receiver.join();
+    close(fd);
+
+    const auto elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    std::cout << "sent: " << sent << " in " << elapsed << "s (" << static_cast<double>(sent) / elapsed << " msg/s)" << std::endl;
+    PrintPercentiles(latencies);
+    return 0;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <deque>
+#include <random>
+
+#include "../OrderType.h"
+#include "../Side.h"
+#include "Protocol.h"
+
+// Synthetic order flow for driving the Gateway and recording backtest event streams.
+// Mostly adds around a slowly wandering mid, with cancels and modifies of earlier orders mixed in.
+class MessageFactory
+{
+private:
+    std::mt19937_64 random_;
+    std::deque<OrderId> resting_;
+    OrderId nextOrderId_{ 1 };
+    Price mid_{ 1'000 };
+    std::uint64_t count_{ };
+
+public:
+    explicit MessageFactory(std::uint64_t seed = 42)
+        : random_{ seed }
+    { }
+
+    OrderMessage Next()
+    {
+        if (++count_ % 100 == 0)
+            mid_ += random_() % 2 ? 1 : -1;
+
+        OrderMessage message{ };
+        const auto roll = random_() % 10;
+        const auto side = random_() % 2 ? Side::Buy : Side::Sell;
+        const auto offset = static_cast<Price>(random_() % 5);
+
+        // Prices straddle the touch so some adds trade, which keeps the book from growing without bound.
+        message.side_ = static_cast<std::uint8_t>(side);
+        message.price_ = side == Side::Buy ? mid_ + 2 - offset : mid_ - 1 + offset;
+        message.quantity_ = static_cast<Quantity>(1 + random_() % 100);
+
+        if (roll < 4 && !resting_.empty()) {
+            message.type_ = MessageType::Cancel;
+            message.orderId_ = resting_.front();
+            resting_.pop_front();
+        }
+        else if (roll < 5 && !resting_.empty()) {
+            message.type_ = MessageType::Modify;
+            message.orderId_ = resting_.front();
+        }
+        else {
+            message.type_ = MessageType::Add;
+            message.orderType_ = static_cast<std::uint8_t>(roll == 9 ? OrderType::FillAndKill : OrderType::GoodTillCancel);
+            message.orderId_ = nextOrderId_++;
+            resting_.push_back(message.orderId_);
+            if (resting_.size() > 1'000)
+                resting_.pop_front();
+        }
+        return message;
+    }
+};
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <type_traits>
+
+#include "../Usings.h"
+
+// Compact fixed-size binary order-entry protocol spoken between the Gateway and its clients.
+// Messages are sent in host byte order; both ends are expected to run on the same architecture.
+
+enum class MessageType : std::uint8_t
+{
+    Add = 1,
+    Cancel = 2,
+    Modify = 3,
+};
+
+enum class ReportType : std::uint8_t
+{
+    Ack = 1,
+    Fill = 2,       // A resting order was filled
+    Reject = 3,     // Refused by the risk stage, reserved_[0] holds the RejectReason
+    Execution = 4,  // An ExecutionSummary for an aggressing order, followed by its CompactFills
+};
+
+struct OrderMessage
+{
+    MessageType type_;
+    std::uint8_t side_;         // Side
+    std::uint8_t orderType_;    // OrderType, only read for Add
+    std::uint8_t reserved_;
+    Price price_;
+    Quantity quantity_;
+    std::uint32_t reserved2_;
+    OrderId orderId_;
+    std::uint64_t clientTimestamp_;  // Echoed back on the Ack so clients can measure round trips, the event time in a recorded stream
+};
+
+struct ExecutionReport
+{
+    ReportType type_;
+    std::uint8_t reserved_[3];
+    Price price_;
+    Quantity quantity_;
+    std::uint32_t reserved2_;
+    OrderId orderId_;
+    std::uint64_t clientTimestamp_;
+};
+
+// Everything an aggressing order traded, sent once instead of a Fill report per fill. The
+// VWAP is left to the client, which gets every fill's price and quantity right behind it.
+struct ExecutionSummary
+{
+    ReportType type_;
+    std::uint8_t reserved_[3];
+    std::uint32_t fillCount_;
+    Quantity filledQuantity_;
+    std::uint32_t levelsTouched_;
+    OrderId orderId_;
+    std::uint64_t clientTimestamp_;
+};
+
+// One fill of the aggressing order, from the passive side. Packed two to a report slot, the
+// last slot is padded with a zeroed record when the count is odd.
+struct CompactFill
+{
+    OrderId passiveOrderId_;
+    Price price_;
+    Quantity quantity_;
+};
+
+using CompactFillSlot = std::array<CompactFill, 2>;
+
+constexpr std::uint32_t GetFillSlotCount(std::uint32_t fillCount) { return (fillCount + 1) / 2; }
+
+// Reports produced by one batch of messages are written together behind a single header. The
+// count is in report-sized slots, CompactFill slots included.
+struct ReportBatchHeader
+{
+    std::uint32_t count_;
+    std::uint32_t reserved_;
+};
+
+static_assert(sizeof(OrderMessage) == 32 && std::is_trivially_copyable_v<OrderMessage>);
+static_assert(sizeof(ExecutionReport) == 32 && std::is_trivially_copyable_v<ExecutionReport>);
+static_assert(sizeof(ExecutionSummary) == sizeof(ExecutionReport) && std::is_trivially_copyable_v<ExecutionSummary>);
+static_assert(sizeof(CompactFillSlot) == sizeof(ExecutionReport) && std::is_trivially_copyable_v<CompactFillSlot>);
+static_assert(sizeof(ReportBatchHeader) == 8);
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "../OrderType.h"
+#include "../Usings.h"
+#include "../gateway/Protocol.h"
+
+// A batch of incoming order commands stored column by column, so checks over one field run
+// over contiguous memory and vectorise. Clear keeps the columns' capacity for the next batch.
+class CommandBatch
+{
+public:
+    void Add(const OrderMessage& message, ParticipantId participantId)
+    {
+        types_.push_back(message.type_);
+        sides_.push_back(message.side_);
+        orderTypes_.push_back(message.orderType_);
+        prices_.push_back(message.price_);
+        quantities_.push_back(message.quantity_);
+        orderIds_.push_back(message.orderId_);
+        participantIds_.push_back(participantId);
+        clientTimestamps_.push_back(message.clientTimestamp_);
+    }
+
+    void Clear()
+    {
+        types_.clear();
+        sides_.clear();
+        orderTypes_.clear();
+        prices_.clear();
+        quantities_.clear();
+        orderIds_.clear();
+        participantIds_.clear();
+        clientTimestamps_.clear();
+    }
+
+    std::size_t Size() const { return types_.size(); }
+    bool Empty() const { return types_.empty(); }
+
+    const std::vector<MessageType>& GetTypes() const { return types_; }
+    const std::vector<std::uint8_t>& GetSides() const { return sides_; }
+    const std::vector<std::uint8_t>& GetOrderTypes() const { return orderTypes_; }
+    const std::vector<Price>& GetPrices() const { return prices_; }
+    const std::vector<Quantity>& GetQuantities() const { return quantities_; }
+    const std::vector<OrderId>& GetOrderIds() const { return orderIds_; }
+    const std::vector<ParticipantId>& GetParticipantIds() const { return participantIds_; }
+    const std::vector<std::uint64_t>& GetClientTimestamps() const { return clientTimestamps_; }
+
+private:
+    std::vector<MessageType> types_;
+    std::vector<std::uint8_t> sides_;
+    std::vector<std::uint8_t> orderTypes_;
+    std::vector<Price> prices_;
+    std::vector<Quantity> quantities_;
+    std::vector<OrderId> orderIds_;
+    std::vector<ParticipantId> participantIds_;
+    std::vector<std::uint64_t> clientTimestamps_;
+};
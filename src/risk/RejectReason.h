@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstdint>
+
+enum class RejectReason : std::uint8_t
+{
+	None,
+	PriceBand,		// Limit price too far from the reference price
+	MaxQuantity,
+	MaxNotional,
+	MaxPosition,	// Would take the participant's position past its limit if filled
+	Malformed,		// Unknown message type, side or order type, or no quantity
+	UnknownOrder,	// Cancel or modify of an order the connection does not have resting
+	DuplicateOrder,	// Add of an order id that is already resting, order ids are shared by all connections
+};
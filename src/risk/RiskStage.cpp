@@ -0,0 +1,138 @@
+#include <algorithm>
+
+#include "RiskStage.h"
+
+
+void RiskStage::Check(const CommandBatch& batch, std::optional<Price> referencePrice, std::vector<RejectReason>& reasons)
+{
+    const std::size_t count = batch.Size();
+    reasons.resize(count);
+
+    const MessageType* types = batch.GetTypes().data();
+    const std::uint8_t* orderTypes = batch.GetOrderTypes().data();
+    const Price* prices = batch.GetPrices().data();
+    const Quantity* quantities = batch.GetQuantities().data();
+    RejectReason* output = reasons.data();
+
+    // An absent reference price turns the band into the whole range of Price.
+    const Price reference = referencePrice.value_or(0);
+    const Price low = referencePrice ? reference - limits_.priceBand_ : std::numeric_limits<Price>::min();
+    const auto bandWidth = referencePrice ? static_cast<std::uint32_t>(2 * limits_.priceBand_) : std::numeric_limits<std::uint32_t>::max();
+    const auto maxQuantity = limits_.maxQuantity_;
+    // A notional is below 2^63, so any larger limit means no limit and is capped to keep the
+    // headroom's sign bit meaningful.
+    const auto maxNotional = std::min<std::uint64_t>(limits_.maxNotional_, std::numeric_limits<std::int64_t>::max());
+    const auto market = static_cast<std::uint8_t>(OrderType::Market);
+
+    // Written as integer arithmetic with no branches, so the compiler vectorises it (at -O3 with
+    // GCC). The band is one unsigned compare, and the notional check reads the sign bit of the
+    // headroom left by a 32 x 32 bit product of the quantity and the price's magnitude, so a
+    // negative price is valued by its size rather than wrapping. Later checks take precedence
+    // when several fail.
+    for (std::size_t i = 0; i < count; ++i) {
+        const std::int32_t isOrder = types[i] != MessageType::Cancel;
+        // The order type is only sent on an Add, a Modify always carries a limit price.
+        const std::int32_t isPriced = (orderTypes[i] != market) | (types[i] == MessageType::Modify);
+        const Price price = isPriced * prices[i] + (1 - isPriced) * reference;
+
+        const auto sign = static_cast<std::uint32_t>(price >> 31);
+        const auto magnitude = (static_cast<std::uint32_t>(price) ^ sign) - sign;
+        const auto notional = static_cast<std::uint64_t>(magnitude) * quantities[i];
+        const auto tooMuchNotional = static_cast<std::int32_t>((maxNotional - notional) >> 63);
+        const std::int32_t tooLarge = quantities[i] > maxQuantity;
+        const std::int32_t outsideBand = isPriced & (static_cast<std::uint32_t>(price) - static_cast<std::uint32_t>(low) > bandWidth);
+
+        std::int32_t reason = tooMuchNotional * static_cast<std::int32_t>(RejectReason::MaxNotional);
+        reason = tooLarge ? static_cast<std::int32_t>(RejectReason::MaxQuantity) : reason;
+        reason = outsideBand ? static_cast<std::int32_t>(RejectReason::PriceBand) : reason;
+        output[i] = static_cast<RejectReason>(isOrder * reason);
+    }
+
+    // Positions need a lookup per participant, so only orders that passed the checks above
+    // get one. Open orders on the same side, and those accepted earlier in the batch, count as
+    // if they will fill. A modify is checked as if the order it replaces were still open.
+    const std::uint8_t* sides = batch.GetSides().data();
+    const ParticipantId* participantIds = batch.GetParticipantIds().data();
+
+    for (std::size_t i = 0; i < count; ++i) {
+        if (output[i] != RejectReason::None || types[i] == MessageType::Cancel)
+            continue;
+
+        const auto participantId = participantIds[i];
+        const auto side = static_cast<std::size_t>(sides[i]);
+        const auto quantity = static_cast<std::int64_t>(quantities[i]);
+
+        if (participantId >= batchExposure_.size())
+            batchExposure_.resize(participantId + 1);
+
+        auto& exposure = batchExposure_[participantId];
+        const auto committed = GetOpenQuantity(participantId, static_cast<Side>(side)) + exposure[side] + quantity;
+        const auto projected = static_cast<Side>(side) == Side::Buy
+            ? GetPosition(participantId) + committed
+            : GetPosition(participantId) - committed;
+
+        if (projected > limits_.maxPosition_ || projected < -limits_.maxPosition_) {
+            output[i] = RejectReason::MaxPosition;
+            continue;
+        }
+
+        if (exposure == SideQuantities{ })
+            exposed_.push_back(participantId);
+        exposure[side] += quantity;
+    }
+
+    for (const auto participantId : exposed_)
+        batchExposure_[participantId] = { };
+    exposed_.clear();
+}
+
+
+void RiskStage::OnAccept(const Order& order)
+{
+    GetOpenQuantities(order.GetParticipantId())[static_cast<std::size_t>(order.GetSide())] += order.GetRemainingQuantity();
+}
+
+
+void RiskStage::OnFill(const Order& aggressor, const Order& resting, Price, Quantity quantity)
+{
+    for (const auto* order : { &aggressor, &resting }) {
+        const auto participantId = order->GetParticipantId();
+        if (participantId >= positions_.size())
+            positions_.resize(participantId + 1);
+
+        positions_[participantId] += order->GetSide() == Side::Buy ? static_cast<std::int64_t>(quantity) : -static_cast<std::int64_t>(quantity);
+        GetOpenQuantities(participantId)[static_cast<std::size_t>(order->GetSide())] -= quantity;
+    }
+}
+
+
+void RiskStage::OnCrossedFill(const Order& buy, const Order& sell, Price price, Quantity quantity)
+{
+    OnFill(buy, sell, price, quantity);
+}
+
+
+void RiskStage::OnCancel(const Order& order, Quantity quantity)
+{
+    GetOpenQuantities(order.GetParticipantId())[static_cast<std::size_t>(order.GetSide())] -= quantity;
+}
+
+
+std::int64_t RiskStage::GetPosition(ParticipantId participantId) const
+{
+    return participantId < positions_.size() ? positions_[participantId] : 0;
+}
+
+
+std::int64_t RiskStage::GetOpenQuantity(ParticipantId participantId, Side side) const
+{
+    return participantId < openQuantities_.size() ? openQuantities_[participantId][static_cast<std::size_t>(side)] : 0;
+}
+
+
+RiskStage::SideQuantities& RiskStage::GetOpenQuantities(ParticipantId participantId)
+{
+    if (participantId >= openQuantities_.size())
+        openQuantities_.resize(participantId + 1);
+    return openQuantities_[participantId];
+}
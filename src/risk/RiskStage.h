@@ -0,0 +1,57 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <vector>
+
+#include "../FillListener.h"
+#include "CommandBatch.h"
+#include "RejectReason.h"
+
+struct RiskLimits
+{
+    Price priceBand_;               // Ticks either side of the reference price a limit price may be
+    Quantity maxQuantity_;
+    std::uint64_t maxNotional_;     // |Price| x quantity, market orders are valued at the reference price, 2^63 and above is no limit
+    std::int64_t maxPosition_;      // Absolute position per participant
+};
+
+// Pre-trade checks for a whole CommandBatch at once, run before any of it reaches the book.
+// Price band, quantity and notional checks are one branch-free pass over the batch's columns;
+// positions are then checked for the orders that survived, counting each participant's open
+// orders on that side as if they will fill. Positions and open quantities are kept current by
+// the OrderBook reporting accepted orders, fills and cancels back through FillListener, in arrays
+// indexed by ParticipantId, which the Gateway hands out sequentially.
+class RiskStage : public FillListener
+{
+public:
+    explicit RiskStage(RiskLimits limits)
+        : limits_{ limits }
+    { }
+
+    // Fills reasons with one entry per command, RejectReason::None for those that may proceed.
+    // Without a reference price the band check is skipped and market orders pass the notional check.
+    void Check(const CommandBatch& batch, std::optional<Price> referencePrice, std::vector<RejectReason>& reasons);
+
+    void OnAccept(const Order& order) override;
+    void OnFill(const Order& aggressor, const Order& resting, Price price, Quantity quantity) override;
+    void OnCrossedFill(const Order& buy, const Order& sell, Price price, Quantity quantity) override;
+    void OnCancel(const Order& order, Quantity quantity) override;
+
+    std::int64_t GetPosition(ParticipantId participantId) const;
+    std::int64_t GetOpenQuantity(ParticipantId participantId, Side side) const;
+
+private:
+    // Indexed by Side, quantities are unsigned on both sides.
+    using SideQuantities = std::array<std::int64_t, 2>;
+
+    RiskLimits limits_;
+    std::vector<std::int64_t> positions_;
+    std::vector<SideQuantities> openQuantities_;    // Quantity of orders in the book not yet filled or cancelled
+    std::vector<SideQuantities> batchExposure_;     // Quantity accepted earlier in the current batch
+    std::vector<ParticipantId> exposed_;            // Entries of batchExposure_ to reset after the batch
+
+    SideQuantities& GetOpenQuantities(ParticipantId participantId);
+};
@@ -1,6 +1,10 @@
 #include "pch.h"
 
-#include "../Orderbook.cpp"
+#include "../OrderBook.cpp"
+#include "../Arena.cpp"
+#include "../risk/RiskStage.cpp"
+#include "../feed/MarketByOrderReplica.cpp"
+#include "../backtest/Simulation.cpp"
 
 namespace googletest = ::testing;
 
@@ -9,16 +13,22 @@ enum class ActionType
     Add,
     Cancel,
     Modify,
+    MassCancel,
 };
 
 struct Information
 {
     ActionType type_;
     OrderType orderType_;
+    PegType pegType_{ PegType::None };
     Side side_;
     Price price_;
     Quantity quantity_;
     OrderId orderId_;
+    ParticipantId participantId_{ };
+    std::optional<Side> massCancelSide_{ };
+    Price minPrice_{ std::numeric_limits<Price>::min() };
+    Price maxPrice_{ std::numeric_limits<Price>::max() };
 };
 
 using Informations = std::vector<Information>;
@@ -65,10 +75,13 @@ private:
         {
             action.type_ = ActionType::Add;
             action.side_ = ParseSide(values[1]);
-            action.orderType_ = ParseOrderType(values[2]);
-            action.price_ = ParsePrice(values[3]);
+            action.pegType_ = ParsePegType(values[2]);
+            action.orderType_ = action.pegType_ == PegType::None ? ParseOrderType(values[2]) : OrderType::GoodTillCancel;
+            action.price_ = action.pegType_ == PegType::None ? ParsePrice(values[3]) : ParsePegOffset(values[3]);
             action.quantity_ = ParseQuantity(values[4]);
             action.orderId_ = ParseOrderId(values[5]);
+            if (values.size() > 6)
+                action.participantId_ = ParseParticipantId(values[6]);
         }
         else if (value == 'M')
         {
@@ -83,6 +96,18 @@ private:
             action.type_ = ActionType::Cancel;
             action.orderId_ = ParseOrderId(values[1]);
         }
+        else if (value == 'X')
+        {
+            action.type_ = ActionType::MassCancel;
+            action.participantId_ = ParseParticipantId(values[1]);
+            if (values.size() > 2)
+                action.massCancelSide_ = ParseSide(values[2]);
+            if (values.size() > 4)
+            {
+                action.minPrice_ = ParsePrice(values[3]);
+                action.maxPrice_ = ParsePrice(values[4]);
+            }
+        }
         else return false;
 
         return true;
@@ -128,6 +153,26 @@ private:
         else throw std::logic_error("Unknown OrderType");
     }
 
+    PegType ParsePegType(const std::string_view& str) const
+    {
+        if (str == "PrimaryPeg")
+            return PegType::Primary;
+        else if (str == "MidpointPeg")
+            return PegType::Midpoint;
+        else return PegType::None;
+    }
+
+    Price ParsePegOffset(const std::string_view& str) const
+    {
+        if (str.empty())
+            throw std::logic_error("Unknown Peg Offset");
+
+        // Offsets may be negative, e.g. a bid pegged one tick behind the best bid.
+        Price value{};
+        std::from_chars(str.data(), str.data() + str.size(), value);
+        return value;
+    }
+
     Price ParsePrice(const std::string_view& str) const
     {
         if (str.empty())
@@ -152,6 +197,14 @@ private:
         return static_cast<OrderId>(ToNumber(str));
     }
 
+    ParticipantId ParseParticipantId(const std::string_view& str) const
+    {
+        if (str.empty())
+            throw std::logic_error("Empty ParticipantId");
+
+        return static_cast<ParticipantId>(ToNumber(str));
+    }
+
 public:
     std::tuple<Informations, Result> GetInformations(const std::filesystem::path& path) const
     {
@@ -218,12 +271,22 @@ TEST_P(OrderbookTestsFixture, OrderbookTestSuite)
 
     auto GetOrder = [](const Information& action)
     {
+        if (action.pegType_ != PegType::None)
+            return std::make_shared<Order>(
+                action.pegType_,
+                action.orderId_,
+                action.side_,
+                action.price_,
+                action.quantity_,
+                action.participantId_);
+
         return std::make_shared<Order>(
             action.orderType_,
             action.orderId_,
             action.side_,
             action.price_,
-            action.quantity_);
+            action.quantity_,
+            action.participantId_);
     };
 
     auto GetOrderModify = [](const Information& action)
@@ -238,7 +301,7 @@ TEST_P(OrderbookTestsFixture, OrderbookTestSuite)
     };
 
     // Act
-    Orderbook orderbook;
+    OrderBook orderbook;
     for (const auto& action : actions)
     {
         switch (action.type_)
@@ -258,6 +321,11 @@ TEST_P(OrderbookTestsFixture, OrderbookTestSuite)
             orderbook.CancelOrder(action.orderId_);
         }
         break;
+        case ActionType::MassCancel:
+        {
+            orderbook.MassCancel(action.participantId_, action.massCancelSide_, action.minPrice_, action.maxPrice_);
+        }
+        break;
         default:
             throw std::logic_error("Unsupported Action.");
         }
@@ -277,5 +345,457 @@ INSTANTIATE_TEST_CASE_P(Tests, OrderbookTestsFixture, googletest::ValuesIn({
     "Match_FillOrKill_Miss.txt",
     "Cancel_Success.txt",
     "Modify_Side.txt",
-    "Match_Market.txt"
+    "Match_Market.txt",
+    "Match_Market_Buy.txt",
+    "MassCancel_Participant.txt",
+    "MassCancel_SideAndPrice.txt",
+    "Peg_Midpoint.txt",
+    "Peg_Cross.txt",
+    "Peg_Lock.txt",
+    "MassCancel_Peg.txt",
+    "Peg_Primary_Priority.txt"
 }));
+
+TEST(OrderbookAnalyticsTests, TracksDepthMicropriceAndVwap)
+{
+    OrderBook orderbook;
+    auto Add = [&orderbook](OrderType type, OrderId id, Side side, Price price, Quantity quantity)
+    {
+        return orderbook.AddOrder(std::make_shared<Order>(type, id, side, price, quantity));
+    };
+
+    // Six bid levels, only the best five count towards depth.
+    for (Price price = 95; price <= 100; ++price)
+        Add(OrderType::GoodTillCancel, static_cast<OrderId>(price), Side::Buy, price, 10);
+    Add(OrderType::GoodTillCancel, 200, Side::Sell, 102, 30);
+
+    auto analytics = orderbook.GetAnalytics();
+    ASSERT_EQ(analytics.bidDepth_, 50u);
+    ASSERT_EQ(analytics.askDepth_, 30u);
+    ASSERT_DOUBLE_EQ(analytics.imbalance_, 20.0 / 80.0);
+    ASSERT_DOUBLE_EQ(analytics.microprice_, (100.0 * 30 + 102.0 * 10) / 40.0);
+    ASSERT_EQ(analytics.sessionVolume_, 0u);
+
+    // Emptying the best level brings the sixth level into the depth.
+    Add(OrderType::GoodTillCancel, 201, Side::Sell, 100, 10);
+    orderbook.CancelOrder(99);
+    Add(OrderType::GoodTillCancel, 202, Side::Buy, 102, 5);
+
+    analytics = orderbook.GetAnalytics();
+    ASSERT_EQ(analytics.bidDepth_, 40u);
+    ASSERT_EQ(analytics.askDepth_, 25u);
+    ASSERT_EQ(analytics.sessionVolume_, 15u);
+    ASSERT_DOUBLE_EQ(analytics.sessionVwap_, (100.0 * 10 + 102.0 * 5) / 15.0);
+    ASSERT_EQ(analytics.rollingVolume_, 15u);
+    ASSERT_DOUBLE_EQ(analytics.rollingVwap_, analytics.sessionVwap_);
+}
+
+TEST(OrderbookAnalyticsTests, RollingVwapExpiresOldTrades)
+{
+    using namespace std::chrono_literals;
+
+    OrderBook orderbook;
+    auto Trade = [&orderbook](OrderId orderId, Price price, Quantity quantity)
+    {
+        orderbook.AddOrder(std::make_shared<Order>(OrderType::GoodTillCancel, orderId, Side::Sell, price, quantity));
+        orderbook.AddOrder(std::make_shared<Order>(OrderType::GoodTillCancel, orderId + 1, Side::Buy, price, quantity));
+    };
+
+    orderbook.SetTime(10s);
+    Trade(1, 100, 10);
+    orderbook.SetTime(40s);
+    Trade(3, 110, 10);
+
+    auto analytics = orderbook.GetAnalytics();
+    ASSERT_EQ(analytics.rollingVolume_, 20u);
+    ASSERT_DOUBLE_EQ(analytics.rollingVwap_, 105.0);
+
+    // The window holds the last VwapWindow whole seconds, the current one included.
+    orderbook.SetTime(9s + OrderBook::VwapWindow);
+    ASSERT_EQ(orderbook.GetAnalytics().rollingVolume_, 20u);
+    orderbook.SetTime(10s + OrderBook::VwapWindow);
+    analytics = orderbook.GetAnalytics();
+    ASSERT_EQ(analytics.rollingVolume_, 10u);
+    ASSERT_DOUBLE_EQ(analytics.rollingVwap_, 110.0);
+
+    // Trades after a long gap reuse buckets without counting what was in them.
+    orderbook.SetTime(500s);
+    Trade(5, 120, 5);
+    analytics = orderbook.GetAnalytics();
+    ASSERT_EQ(analytics.rollingVolume_, 5u);
+    ASSERT_DOUBLE_EQ(analytics.rollingVwap_, 120.0);
+    ASSERT_EQ(analytics.sessionVolume_, 25u);
+}
+
+TEST(OrderbookExecutionTests, SummarisesAggressorSweep)
+{
+    OrderBook orderbook;
+    for (OrderId orderId = 1; orderId <= 6; ++orderId)
+        orderbook.AddOrder(std::make_shared<Order>(OrderType::GoodTillCancel, orderId, Side::Sell, static_cast<Price>(100 + (orderId - 1) / 2), 10));
+
+    // Takes both orders at 100 and 101 and half of the first at 102.
+    AggressorExecution execution;
+    orderbook.AddOrder(std::make_shared<Order>(OrderType::FillAndKill, 7, Side::Buy, 102, 45), execution);
+
+    ASSERT_EQ(execution.GetOrderId(), 7u);
+    ASSERT_EQ(execution.GetFilledQuantity(), 45u);
+    ASSERT_EQ(execution.GetLevelsTouched(), 3u);
+    ASSERT_EQ(execution.GetFills().size(), 5u);
+    ASSERT_EQ(execution.GetFills().back().passiveOrderId_, 5u);
+    ASSERT_EQ(execution.GetFills().back().quantity_, 5u);
+    ASSERT_DOUBLE_EQ(execution.GetVwap(), (100.0 * 20 + 101.0 * 20 + 102.0 * 5) / 45.0);
+    ASSERT_EQ(orderbook.Size(), 2u);
+}
+
+
+TEST(OrderbookRiskTests, RejectsBatchWithReasonsAndTracksPositions)
+{
+    OrderBook orderbook;
+    RiskStage riskStage{ RiskLimits{ .priceBand_ = 10, .maxQuantity_ = 100, .maxNotional_ = 5'000, .maxPosition_ = 60 } };
+    orderbook.SetFillListener(&riskStage);
+
+    orderbook.AddOrder(std::make_shared<Order>(OrderType::GoodTillCancel, 1, Side::Sell, 50, 40, 2));
+    orderbook.AddOrder(std::make_shared<Order>(OrderType::GoodTillCancel, 2, Side::Buy, 50, 40, 1));
+    ASSERT_EQ(riskStage.GetPosition(1), 40);
+    ASSERT_EQ(riskStage.GetPosition(2), -40);
+
+    auto Message = [](MessageType type, Side side, Price price, Quantity quantity)
+    {
+        return OrderMessage{ type, static_cast<std::uint8_t>(side), static_cast<std::uint8_t>(OrderType::GoodTillCancel), { }, price, quantity };
+    };
+
+    CommandBatch batch;
+    batch.Add(Message(MessageType::Add, Side::Buy, 70, 1), 3);
+    batch.Add(Message(MessageType::Add, Side::Buy, 50, 101), 3);
+    batch.Add(Message(MessageType::Add, Side::Buy, 60, 90), 3);
+    batch.Add(Message(MessageType::Add, Side::Buy, 50, 15), 1);
+    batch.Add(Message(MessageType::Add, Side::Buy, 50, 10), 1);
+    batch.Add(Message(MessageType::Add, Side::Sell, 50, 100), 1);
+    batch.Add(Message(MessageType::Cancel, Side::Buy, 0, 0), 1);
+
+    std::vector<RejectReason> reasons;
+    riskStage.Check(batch, 50, reasons);
+
+    ASSERT_EQ(reasons.size(), 7u);
+    ASSERT_EQ(reasons[0], RejectReason::PriceBand);
+    ASSERT_EQ(reasons[1], RejectReason::MaxQuantity);
+    ASSERT_EQ(reasons[2], RejectReason::MaxNotional);
+    ASSERT_EQ(reasons[3], RejectReason::None);
+    // Counts the 15 accepted above, taking the position to 65.
+    ASSERT_EQ(reasons[4], RejectReason::MaxPosition);
+    ASSERT_EQ(reasons[5], RejectReason::None);
+    ASSERT_EQ(reasons[6], RejectReason::None);
+}
+
+TEST(OrderbookRiskTests, CountsOpenOrdersAcrossBatches)
+{
+    OrderBook orderbook;
+    RiskStage riskStage{ RiskLimits{ .priceBand_ = 10, .maxQuantity_ = 100, .maxNotional_ = 1'000'000, .maxPosition_ = 60 } };
+    orderbook.SetFillListener(&riskStage);
+
+    auto Message = [](MessageType type, Side side, OrderType orderType, Price price, Quantity quantity)
+    {
+        return OrderMessage{ type, static_cast<std::uint8_t>(side), static_cast<std::uint8_t>(orderType), { }, price, quantity };
+    };
+
+    orderbook.AddOrder(std::make_shared<Order>(OrderType::GoodTillCancel, 1, Side::Buy, 50, 50, 1));
+    ASSERT_EQ(riskStage.GetOpenQuantity(1, Side::Buy), 50);
+
+    CommandBatch batch;
+    batch.Add(Message(MessageType::Add, Side::Buy, OrderType::GoodTillCancel, 50, 15), 1);
+    batch.Add(Message(MessageType::Add, Side::Sell, OrderType::GoodTillCancel, 50, 60), 1);
+    // The order type of a Modify is not read, its price is still checked.
+    batch.Add(Message(MessageType::Modify, Side::Buy, OrderType::Market, 80, 1), 1);
+
+    std::vector<RejectReason> reasons;
+    riskStage.Check(batch, 50, reasons);
+
+    ASSERT_EQ(reasons.size(), 3u);
+    // The resting 50 counts as bought, taking the position to 65.
+    ASSERT_EQ(reasons[0], RejectReason::MaxPosition);
+    ASSERT_EQ(reasons[1], RejectReason::None);
+    ASSERT_EQ(reasons[2], RejectReason::PriceBand);
+
+    // Fills move open quantity into the position, cancels and killed remainders release it.
+    orderbook.AddOrder(std::make_shared<Order>(OrderType::GoodTillCancel, 2, Side::Sell, 50, 20, 2));
+    ASSERT_EQ(riskStage.GetPosition(1), 20);
+    ASSERT_EQ(riskStage.GetOpenQuantity(1, Side::Buy), 30);
+    ASSERT_EQ(riskStage.GetOpenQuantity(2, Side::Sell), 0);
+
+    orderbook.CancelOrder(1);
+    orderbook.AddOrder(std::make_shared<Order>(OrderType::FillAndKill, 3, Side::Buy, 50, 10, 1));
+    ASSERT_EQ(riskStage.GetOpenQuantity(1, Side::Buy), 0);
+
+    batch.Clear();
+    batch.Add(Message(MessageType::Add, Side::Buy, OrderType::GoodTillCancel, 50, 40), 1);
+    riskStage.Check(batch, 50, reasons);
+    ASSERT_EQ(reasons[0], RejectReason::None);
+}
+
+TEST(OrderbookRiskTests, ChecksNotionalOverWholeRangeAndNegativePrices)
+{
+    auto Message = [](Price price, Quantity quantity)
+    {
+        return OrderMessage{ MessageType::Add, static_cast<std::uint8_t>(Side::Buy), static_cast<std::uint8_t>(OrderType::GoodTillCancel), { }, price, quantity };
+    };
+
+    CommandBatch batch;
+    batch.Add(Message(-5, 10), 1);
+    batch.Add(Message(-20, 10), 1);
+    batch.Add(Message(20, 10), 1);
+
+    // No notional limit at all.
+    RiskStage unlimited{ RiskLimits{ .priceBand_ = 50, .maxQuantity_ = 100, .maxNotional_ = std::numeric_limits<std::uint64_t>::max(), .maxPosition_ = 1'000 } };
+    std::vector<RejectReason> reasons;
+    unlimited.Check(batch, 0, reasons);
+    ASSERT_EQ(reasons, std::vector<RejectReason>(3, RejectReason::None));
+
+    // Negative prices are valued by their magnitude.
+    RiskStage limited{ RiskLimits{ .priceBand_ = 50, .maxQuantity_ = 100, .maxNotional_ = 100, .maxPosition_ = 1'000 } };
+    limited.Check(batch, 0, reasons);
+    ASSERT_EQ(reasons[0], RejectReason::None);
+    ASSERT_EQ(reasons[1], RejectReason::MaxNotional);
+    ASSERT_EQ(reasons[2], RejectReason::MaxNotional);
+}
+
+TEST(OrderbookMarketByOrderTests, ReplicaFromChunkedSnapshotMatchesBook)
+{
+    OrderBook orderbook;
+    MarketByOrderRing ring{ 64 };
+    orderbook.SetMarketByOrderRing(&ring);
+
+    auto Add = [&orderbook](OrderType orderType, OrderId orderId, Side side, Price price, Quantity quantity, AggressorExecution& execution)
+    {
+        orderbook.AddOrder(std::make_shared<Order>(orderType, orderId, side, price, quantity), execution);
+    };
+
+    AggressorExecution execution;
+    Add(OrderType::GoodTillCancel, 1, Side::Buy, 100, 10, execution);
+    Add(OrderType::GoodTillCancel, 2, Side::Buy, 100, 10, execution);
+    Add(OrderType::GoodTillCancel, 3, Side::Buy, 99, 10, execution);
+    Add(OrderType::GoodTillCancel, 4, Side::Buy, 98, 10, execution);
+    Add(OrderType::GoodTillCancel, 5, Side::Sell, 101, 10, execution);
+    Add(OrderType::GoodTillCancel, 6, Side::Sell, 102, 10, execution);
+    Add(OrderType::GoodTillCancel, 7, Side::Sell, 102, 10, execution);
+    ASSERT_EQ(orderbook.GetBookSequence(), 7u);
+
+    // The book keeps changing between chunks, on both sides of the copy cursor.
+    MarketByOrderSnapshot snapshot;
+    ASSERT_FALSE(orderbook.CopyOrders(snapshot, 2));
+    orderbook.CancelOrder(1);
+    orderbook.ModifyOrder(OrderModify{ 2, Side::Buy, 100, 4 }, execution);
+    orderbook.ModifyOrder(OrderModify{ 3, Side::Buy, 100, 10 }, execution);
+    orderbook.ModifyOrder(OrderModify{ 4, Side::Buy, 97, 10 }, execution);
+    ASSERT_FALSE(orderbook.CopyOrders(snapshot, 2));
+
+    // The reduced order kept its place ahead of the one that joined its level.
+    Add(OrderType::FillAndKill, 8, Side::Sell, 100, 8, execution);
+    ASSERT_EQ(execution.GetFills().front().passiveOrderId_, 2u);
+
+    while (!orderbook.CopyOrders(snapshot, 2))
+        Add(OrderType::GoodTillCancel, 9 + snapshot.orders_.size(), Side::Sell, 110, 1, execution);
+
+    MarketByOrderReplica replica;
+    replica.Load(snapshot);
+    MarketByOrderEvent event;
+    for (auto sequence = snapshot.startSequence_ + 1; ring.Read(sequence, event) == RingRead::Ready; ++sequence)
+        replica.Apply(event);
+
+    ASSERT_TRUE(replica.IsConsistent());
+    ASSERT_EQ(replica.GetSequence(), orderbook.GetBookSequence());
+
+    MarketByOrderSnapshot expected;
+    ASSERT_TRUE(orderbook.CopyOrders(expected, orderbook.Size()));
+    ASSERT_EQ(replica.Size(), expected.orders_.size());
+    for (const auto& order : expected.orders_) {
+        const auto* entry = replica.Find(order.orderId_);
+        ASSERT_NE(entry, nullptr);
+        ASSERT_EQ(entry->side_, order.side_);
+        ASSERT_EQ(entry->price_, order.price_);
+        ASSERT_EQ(entry->quantity_, order.quantity_);
+    }
+
+    ASSERT_EQ(replica.Find(3)->quantity_, 6u);
+    ASSERT_EQ(replica.GetQueue(Side::Sell, 102)->front(), 6u);
+}
+
+TEST(OrderbookMarketByOrderTests, ChunkedCopyResumesAfterLastOrderLeaves)
+{
+    OrderBook orderbook;
+    for (OrderId orderId = 1; orderId <= 4; ++orderId)
+        orderbook.AddOrder(std::make_shared<Order>(OrderType::GoodTillCancel, orderId, Side::Buy, 100, 10));
+
+    auto OrderIdsOf = [](const MarketByOrderSnapshot& snapshot)
+    {
+        std::vector<OrderId> orderIds;
+        for (const auto& entry : snapshot.orders_)
+            orderIds.push_back(entry.orderId_);
+        return orderIds;
+    };
+
+    // The last order copied is cancelled, the copy carries on with the orders that queued behind it.
+    MarketByOrderSnapshot cancelled;
+    ASSERT_FALSE(orderbook.CopyOrders(cancelled, 2));
+    orderbook.CancelOrder(2);
+    ASSERT_TRUE(orderbook.CopyOrders(cancelled, 4));
+    ASSERT_EQ(OrderIdsOf(cancelled), (std::vector<OrderId>{ 1, 2, 3, 4 }));
+
+    // The last order copied is re-added at the back by a modify, the order it used to be ahead of is not skipped.
+    MarketByOrderSnapshot replaced;
+    ASSERT_FALSE(orderbook.CopyOrders(replaced, 2));
+    orderbook.ModifyOrder(OrderModify{ 3, Side::Buy, 100, 20 });
+    ASSERT_TRUE(orderbook.CopyOrders(replaced, 4));
+    ASSERT_EQ(OrderIdsOf(replaced), (std::vector<OrderId>{ 1, 3, 4, 3 }));
+}
+
+TEST(OrderbookMarketByOrderTests, ChunkedCopyCountsSkippedOrders)
+{
+    OrderBook orderbook;
+    for (OrderId orderId = 1; orderId <= 6; ++orderId)
+        orderbook.AddOrder(std::make_shared<Order>(OrderType::GoodTillCancel, orderId, Side::Buy, 100, 10));
+
+    MarketByOrderSnapshot snapshot;
+    ASSERT_FALSE(orderbook.CopyOrders(snapshot, 4));
+    orderbook.CancelOrder(4);
+
+    // Walking back past the orders already copied uses up the chunk before anything new is copied.
+    ASSERT_FALSE(orderbook.CopyOrders(snapshot, 2));
+    ASSERT_EQ(snapshot.orders_.size(), 4u);
+    ASSERT_FALSE(orderbook.CopyOrders(snapshot, 2));
+    ASSERT_EQ(snapshot.orders_.size(), 5u);
+    ASSERT_TRUE(orderbook.CopyOrders(snapshot, 2));
+
+    std::vector<OrderId> orderIds;
+    for (const auto& entry : snapshot.orders_)
+        orderIds.push_back(entry.orderId_);
+    ASSERT_EQ(orderIds, (std::vector<OrderId>{ 1, 2, 3, 4, 5, 6 }));
+}
+
+TEST(OrderbookArenaTests, ReusesFreedBlocksAndFallsBackToHeap)
+{
+    Arena arena{ 1, Arena::Options{ .hugePages_ = false, .prefault_ = false, .bindToLocalNode_ = false } };
+
+    void* first = arena.Allocate(40, 8);
+    void* second = arena.Allocate(48, 8);
+    ASSERT_TRUE(arena.Owns(first));
+    ASSERT_TRUE(arena.Owns(second));
+    const auto used = arena.GetUsed();
+
+    // A freed block goes to the next request of its size class without growing the region.
+    arena.Deallocate(first, 40, 8);
+    ASSERT_EQ(arena.Allocate(33, 8), first);
+    ASSERT_EQ(arena.GetUsed(), used);
+    void* otherClass = arena.Allocate(64, 8);
+    ASSERT_NE(otherClass, first);
+    ASSERT_GT(arena.GetUsed(), used);
+
+    // Once the region is used up requests come from the heap, and are given back to it.
+    constexpr std::size_t Large = 1024 * 1024;
+    while (arena.GetCapacity() - arena.GetUsed() >= Large)
+        ASSERT_TRUE(arena.Owns(arena.Allocate(Large, 8)));
+
+    void* overflow = arena.Allocate(Large, 8);
+    ASSERT_NE(overflow, nullptr);
+    ASSERT_FALSE(arena.Owns(overflow));
+    arena.Deallocate(overflow, Large, 8);
+}
+
+TEST(OrderbookArenaTests, RunsOrderbookOnArena)
+{
+    Arena arena{ 8 * 1024 * 1024, Arena::Options{ .hugePages_ = false, .prefault_ = false, .bindToLocalNode_ = false } };
+    OrderBook orderbook{ &arena };
+
+    for (OrderId orderId = 1; orderId <= 100; ++orderId) {
+        const auto side = orderId % 2 ? Side::Buy : Side::Sell;
+        auto order = orderbook.MakeOrder(OrderType::GoodTillCancel, orderId, side, side == Side::Buy ? 99 : 101, 10);
+        ASSERT_TRUE(arena.Owns(order.get()));
+        orderbook.AddOrder(order);
+    }
+    ASSERT_GT(arena.GetUsed(), 0u);
+
+    for (OrderId orderId = 1; orderId <= 20; ++orderId)
+        orderbook.CancelOrder(orderId);
+
+    const auto trades = orderbook.AddOrder(orderbook.MakeOrder(OrderType::FillAndKill, 101, Side::Buy, 101, 25));
+    ASSERT_EQ(trades.size(), 3u);
+    ASSERT_EQ(orderbook.Size(), 78u);
+    ASSERT_EQ(orderbook.GetLevelQuantity(Side::Sell, 101), 375u);
+    ASSERT_EQ(orderbook.GetLevelQuantity(Side::Buy, 99), 400u);
+}
+
+namespace
+{
+    OrderMessage SimulationEvent(MessageType type, Side side, Price price, Quantity quantity, OrderId orderId)
+    {
+        return OrderMessage{ type, static_cast<std::uint8_t>(side), static_cast<std::uint8_t>(OrderType::GoodTillCancel), { }, price, quantity, { }, orderId };
+    }
+
+    // Quotes are placed once, right after the first requoteInterval events have built the book.
+    StrategyParameters SimulationParameters(Price quoteOffset, std::size_t requoteInterval)
+    {
+        return StrategyParameters{ .quoteOffset_ = quoteOffset, .quoteSize_ = 5, .requoteInterval_ = requoteInterval, .maxPosition_ = 100 };
+    }
+}
+
+TEST(OrderbookSimulationTests, JoinsBehindAndConsumesVolumeAhead)
+{
+    const std::vector<OrderMessage> events{
+        SimulationEvent(MessageType::Add, Side::Sell, 101, 10, 1),
+        SimulationEvent(MessageType::Add, Side::Buy, 100, 10, 2),
+        SimulationEvent(MessageType::Add, Side::Buy, 100, 5, 3),
+        // Quotes join at 100 behind 15 and at 101 behind 10, order 4 queues behind the bid.
+        SimulationEvent(MessageType::Add, Side::Buy, 100, 4, 4),
+        SimulationEvent(MessageType::Add, Side::Sell, 100, 12, 5),
+        SimulationEvent(MessageType::Add, Side::Sell, 100, 6, 6),
+    };
+
+    const auto result = Simulation{ events, SimulationParameters(0, 3) }.Run();
+
+    // 12 then 3 of the 15 ahead are consumed, the last 3 traded against order 4 fill the quote.
+    ASSERT_EQ(result.averageQueueAhead_, 12.5);
+    ASSERT_EQ(result.fills_, 1u);
+    ASSERT_EQ(result.filledQuantity_, 3u);
+    ASSERT_EQ(result.position_, 3);
+}
+
+TEST(OrderbookSimulationTests, TradeThroughFillsQuote)
+{
+    const std::vector<OrderMessage> events{
+        SimulationEvent(MessageType::Add, Side::Sell, 101, 10, 1),
+        SimulationEvent(MessageType::Add, Side::Buy, 100, 10, 2),
+        SimulationEvent(MessageType::Add, Side::Buy, 99, 20, 3),
+        SimulationEvent(MessageType::Add, Side::Buy, 98, 5, 4),
+        // The bid quote joins at 99 behind 20, trading down to 98 goes through it.
+        SimulationEvent(MessageType::Add, Side::Sell, 98, 33, 5),
+    };
+
+    const auto result = Simulation{ events, SimulationParameters(1, 4) }.Run();
+
+    ASSERT_EQ(result.fills_, 1u);
+    ASSERT_EQ(result.filledQuantity_, 3u);
+    ASSERT_EQ(result.position_, 3);
+}
+
+TEST(OrderbookSimulationTests, ShrinkingLevelClampsVolumeAhead)
+{
+    const std::vector<OrderMessage> events{
+        SimulationEvent(MessageType::Add, Side::Sell, 101, 10, 1),
+        SimulationEvent(MessageType::Add, Side::Sell, 102, 10, 2),
+        SimulationEvent(MessageType::Add, Side::Buy, 100, 10, 3),
+        SimulationEvent(MessageType::Add, Side::Buy, 100, 5, 4),
+        SimulationEvent(MessageType::Add, Side::Buy, 99, 1, 5),
+        // The bid quote joins at 100 behind 15.
+        SimulationEvent(MessageType::Add, Side::Buy, 100, 4, 6),
+        SimulationEvent(MessageType::Cancel, Side::Buy, 0, 0, 3),
+        SimulationEvent(MessageType::Add, Side::Buy, 100, 10, 7),
+        SimulationEvent(MessageType::Add, Side::Sell, 100, 12, 8),
+    };
+
+    const auto result = Simulation{ events, SimulationParameters(0, 5) }.Run();
+
+    // The cancel leaves 9 at the level, so at most 9 can still be ahead of the quote. Without
+    // the clamp the 12 sold would all have gone to the 15 it joined behind.
+    ASSERT_EQ(result.fills_, 1u);
+    ASSERT_EQ(result.filledQuantity_, 3u);
+    ASSERT_EQ(result.position_, 3);
+}
\ No newline at end of file